@@ -1506,6 +1506,18 @@ Position ScintillaCall::ReplaceTargetMinimal(Position length, const char *text)
 	return CallString(Message::ReplaceTargetMinimal, length, text);
 }
 
+Position ScintillaCall::ReplaceTargetDiff(Position length, const char *text) {
+	return CallString(Message::ReplaceTargetDiff, length, text);
+}
+
+void ScintillaCall::SetReplaceAllSearch(Position length, const char *text) {
+	CallString(Message::SetReplaceAllSearch, length, text);
+}
+
+Position ScintillaCall::ReplaceAllInTarget(Position length, const char *text) {
+	return CallString(Message::ReplaceAllInTarget, length, text);
+}
+
 Position ScintillaCall::SearchInTarget(Position length, const char *text) {
 	return CallString(Message::SearchInTarget, length, text);
 }
@@ -1770,6 +1782,30 @@ LineCache ScintillaCall::LayoutCache() {
 	return static_cast<Scintilla::LineCache>(Call(Message::GetLayoutCache));
 }
 
+void ScintillaCall::SetLayoutCacheBudget(Position bytes) {
+	Call(Message::SetLayoutCacheBudget, bytes);
+}
+
+Position ScintillaCall::LayoutCacheBudget() {
+	return Call(Message::GetLayoutCacheBudget);
+}
+
+void ScintillaCall::SetLayoutCacheCompact(bool compact) {
+	Call(Message::SetLayoutCacheCompact, compact);
+}
+
+bool ScintillaCall::LayoutCacheCompact() {
+	return Call(Message::GetLayoutCacheCompact);
+}
+
+Position ScintillaCall::LayoutCacheHits() {
+	return Call(Message::GetLayoutCacheHits);
+}
+
+Position ScintillaCall::LayoutCacheMisses() {
+	return Call(Message::GetLayoutCacheMisses);
+}
+
 void ScintillaCall::SetScrollWidth(int pixelWidth) {
 	Call(Message::SetScrollWidth, pixelWidth);
 }
@@ -1786,6 +1822,14 @@ bool ScintillaCall::ScrollWidthTracking() {
 	return Call(Message::GetScrollWidthTracking);
 }
 
+void ScintillaCall::SetScrollWidthExact(bool exact) {
+	Call(Message::SetScrollWidthExact, exact);
+}
+
+bool ScintillaCall::ScrollWidthExact() {
+	return Call(Message::GetScrollWidthExact);
+}
+
 int ScintillaCall::TextWidth(int style, const char *text) {
 	return static_cast<int>(CallString(Message::TextWidth, style, text));
 }
@@ -1814,6 +1858,18 @@ void ScintillaCall::AppendText(Position length, const char *text) {
 	CallString(Message::AppendText, length, text);
 }
 
+void ScintillaCall::AppendTextDeferred(Position length, const char *text) {
+	CallString(Message::AppendTextDeferred, length, text);
+}
+
+void ScintillaCall::SetAppendLineLimit(Line lines) {
+	Call(Message::SetAppendLineLimit, lines);
+}
+
+Line ScintillaCall::AppendLineLimit() {
+	return Call(Message::GetAppendLineLimit);
+}
+
 PhasesDraw ScintillaCall::PhasesDraw() {
 	return static_cast<Scintilla::PhasesDraw>(Call(Message::GetPhasesDraw));
 }
@@ -912,6 +912,7 @@ sptr_t ScintillaCocoa::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 			return 0;
 
 		case Message::TargetAsUTF8:
+			CommitAppended();
 			return TargetAsUTF8(CharPtrFromSPtr(lParam));
 
 		case Message::EncodedFromUTF8:
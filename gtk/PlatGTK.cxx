@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <algorithm>
 #include <memory>
 #include <sstream>
@@ -152,7 +153,7 @@ public:
 	~SurfaceImpl() override = default;
 
 	void GetContextState() noexcept;
-	UniquePangoContext MeasuringContext();
+	PangoLayout *MeasuringLayout();
 
 	void Init(WindowID wid) override;
 	void Init(SurfaceID sid, WindowID wid) override;
@@ -178,6 +179,8 @@ public:
 	void AlphaRectangle(PRectangle rc, XYPOSITION cornerSize, FillStroke fillStroke) override;
 	void GradientRectangle(PRectangle rc, const std::vector<ColourStop> &stops, GradientOptions options) override;
 	void DrawRGBAImage(PRectangle rc, int width, int height, const unsigned char *pixelsImage) override;
+	std::shared_ptr<ImageHandle> CreateImageHandle(int width, int height, const unsigned char *pixelsImage) override;
+	bool DrawImageHandle(PRectangle rc, ImageHandle *handle) override;
 	void Ellipse(PRectangle rc, FillStroke fillStroke) override;
 	void Stadium(PRectangle rc, FillStroke fillStroke, Ends ends) override;
 	void Copy(PRectangle rc, Point from, Surface &surfaceSource) override;
@@ -188,6 +191,8 @@ public:
 	void DrawTextNoClip(PRectangle rc, const Font *font_, XYPOSITION ybase, Sci::string_view text, ColourRGBA fore, ColourRGBA back) override;
 	void DrawTextClipped(PRectangle rc, const Font *font_, XYPOSITION ybase, Sci::string_view text, ColourRGBA fore, ColourRGBA back) override;
 	void DrawTextTransparent(PRectangle rc, const Font *font_, XYPOSITION ybase, Sci::string_view text, ColourRGBA fore) override;
+	std::shared_ptr<ShapedText> ShapeText(const Font *font_, Sci::string_view text) override;
+	bool DrawShapedText(PRectangle rc, const ShapedText *shaped, XYPOSITION ybase, ColourRGBA fore) override;
 	void MeasureWidths(const Font *font_, Sci::string_view text, XYPOSITION *positions) override;
 	XYPOSITION WidthText(const Font *font_, Sci::string_view text) override;
 
@@ -197,6 +202,8 @@ public:
 	void DrawTextTransparentUTF8(PRectangle rc, const Font *font_, XYPOSITION ybase, Sci::string_view text, ColourRGBA fore) override;
 	void MeasureWidthsUTF8(const Font *font_, Sci::string_view text, XYPOSITION *positions) override;
 	XYPOSITION WidthTextUTF8(const Font *font_, Sci::string_view text) override;
+	void MeasureWidthsBatchUTF8(const TextMeasureRequest *requests, size_t count) override;
+	bool MeasureBatchLayout(const TextMeasureRequest *requests, size_t count);
 
 	XYPOSITION Ascent(const Font *font_) override;
 	XYPOSITION Descent(const Font *font_) override;
@@ -216,6 +223,7 @@ const Supports SupportsGTK[] = {
 	Supports::TranslucentStroke,
 	Supports::PixelModification,
 	Supports::ThreadSafeMeasureWidths,
+	Supports::ShapedText,
 };
 
 }
@@ -360,19 +368,76 @@ void SurfaceImpl::GetContextState() noexcept {
 	language = pango_context_get_language(pcontext.get());
 }
 
-UniquePangoContext SurfaceImpl::MeasuringContext() {
+namespace {
+
+// Creating a PangoContext and PangoLayout for each measurement is expensive so they
+// are pooled per thread, keyed on the context state that affects measurement.
+// Each thread owns its entries so concurrent MeasureWidths calls from wrapping
+// threads never share a PangoLayout.
+struct MeasuringState {
+	double resolution = 1.0;
+	PangoDirection direction = PANGO_DIRECTION_LTR;
+	UniqueCairoFontOptions fontOptions;
+	PangoLanguage *language = nullptr;	// PangoLanguage objects are never freed
+	UniquePangoContext context;
+	UniquePangoLayout layout;
+
+	bool Matches(double resolution_, PangoDirection direction_,
+		const cairo_font_options_t *fontOptions_, PangoLanguage *language_) const noexcept {
+		if ((resolution != resolution_) || (direction != direction_) || (language != language_))
+			return false;
+		if (!fontOptions || !fontOptions_)
+			return !fontOptions && !fontOptions_;
+		return cairo_font_options_equal(fontOptions.get(), fontOptions_);
+	}
+};
+
+// Only a few distinct states occur in practice, such as one per screen resolution.
+constexpr size_t maxMeasuringStates = 4;
+
+thread_local std::vector<MeasuringState> measuringStates;
+
+}
+
+PangoLayout *SurfaceImpl::MeasuringLayout() {
+	for (size_t i = 0; i < measuringStates.size(); i++) {
+		if (measuringStates[i].Matches(resolution, direction, fontOptions, language)) {
+			if (i > 0) {
+				// Move to front so the most recently used state is found first
+				std::rotate(measuringStates.begin(), measuringStates.begin() + i, measuringStates.begin() + i + 1);
+			}
+			return measuringStates.front().layout.get();
+		}
+	}
+
+	MeasuringState state;
+	state.resolution = resolution;
+	state.direction = direction;
+	if (fontOptions) {
+		// Copy as fontOptions is owned by pcontext which may be released before this state
+		state.fontOptions.reset(cairo_font_options_copy(fontOptions));
+	}
+	state.language = language;
+
 	UniquePangoFontMap fmMeasure(pango_cairo_font_map_get_default());
 	PLATFORM_ASSERT(fmMeasure);
-	UniquePangoContext contextMeasure(pango_font_map_create_context(fmMeasure.release()));
-	PLATFORM_ASSERT(contextMeasure);
-	SetFractionalPositions(contextMeasure.get());
+	state.context.reset(pango_font_map_create_context(fmMeasure.release()));
+	PLATFORM_ASSERT(state.context);
+	SetFractionalPositions(state.context.get());
+
+	pango_cairo_context_set_resolution(state.context.get(), resolution);
+	pango_context_set_base_dir(state.context.get(), direction);
+	pango_cairo_context_set_font_options(state.context.get(), fontOptions);
+	pango_context_set_language(state.context.get(), language);
 
-	pango_cairo_context_set_resolution(contextMeasure.get(), resolution);
-	pango_context_set_base_dir(contextMeasure.get(), direction);
-	pango_cairo_context_set_font_options(contextMeasure.get(), fontOptions);
-	pango_context_set_language(contextMeasure.get(), language);
+	state.layout.reset(pango_layout_new(state.context.get()));
+	PLATFORM_ASSERT(state.layout);
 
-	return contextMeasure;
+	if (measuringStates.size() >= maxMeasuringStates) {
+		measuringStates.pop_back();
+	}
+	measuringStates.insert(measuringStates.begin(), std::move(state));
+	return measuringStates.front().layout.get();
 }
 
 void SurfaceImpl::Init(WindowID wid) {
@@ -606,16 +671,54 @@ void SurfaceImpl::GradientRectangle(PRectangle rc, const std::vector<ColourStop>
 	}
 }
 
-void SurfaceImpl::DrawRGBAImage(PRectangle rc, int width, int height, const unsigned char *pixelsImage) {
-	PLATFORM_ASSERT(context);
-	if (width == 0)
-		return;
+namespace {
+
+// An RGBA image converted to a premultiplied cairo image surface.
+class ImageHandleCairo : public ImageHandle {
+public:
+	int width;
+	int height;
+	UniqueCairoSurface surfImage;
+	ImageHandleCairo(int width_, int height_, const unsigned char *pixelsImage) :
+		width(width_), height(height_),
+		surfImage(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width_, height_)) {
+		cairo_surface_flush(surfImage.get());
+		unsigned char *data = cairo_image_surface_get_data(surfImage.get());
+		const int stride = cairo_image_surface_get_stride(surfImage.get());
+		if (data) {
+			for (ptrdiff_t iy=0; iy<height; iy++) {
+				RGBAImage::BGRAFromRGBA(data + iy*stride, pixelsImage, width);
+				pixelsImage += RGBAImage::bytesPerPixel * width;
+			}
+		}
+		cairo_surface_mark_dirty(surfImage.get());
+	}
+};
+
+// Centre an image of width x height in rc.
+PRectangle ImageRectangle(PRectangle rc, int width, int height) noexcept {
 	if (rc.Width() > width)
 		rc.left += (rc.Width() - width) / 2;
 	rc.right = rc.left + width;
 	if (rc.Height() > height)
 		rc.top += (rc.Height() - height) / 2;
 	rc.bottom = rc.top + height;
+	return rc;
+}
+
+void PaintImageSurface(cairo_t *context, PRectangle rc, cairo_surface_t *surfImage) noexcept {
+	cairo_set_source_surface(context, surfImage, rc.left, rc.top);
+	cairo_rectangle(context, rc.left, rc.top, rc.Width(), rc.Height());
+	cairo_fill(context);
+}
+
+}
+
+void SurfaceImpl::DrawRGBAImage(PRectangle rc, int width, int height, const unsigned char *pixelsImage) {
+	PLATFORM_ASSERT(context);
+	if (width == 0)
+		return;
+	rc = ImageRectangle(rc, width, height);
 
 	const int stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
 	const int ucs = stride * height;
@@ -627,9 +730,24 @@ void SurfaceImpl::DrawRGBAImage(PRectangle rc, int width, int height, const unsi
 	}
 
 	UniqueCairoSurface surfImage(cairo_image_surface_create_for_data(&image[0], CAIRO_FORMAT_ARGB32, width, height, stride));
-	cairo_set_source_surface(context, surfImage.get(), rc.left, rc.top);
-	cairo_rectangle(context, rc.left, rc.top, rc.Width(), rc.Height());
-	cairo_fill(context);
+	PaintImageSurface(context, rc, surfImage.get());
+}
+
+std::shared_ptr<ImageHandle> SurfaceImpl::CreateImageHandle(int width, int height, const unsigned char *pixelsImage) {
+	if (width <= 0 || height <= 0)
+		return nullptr;
+	std::shared_ptr<ImageHandleCairo> handle = std::make_shared<ImageHandleCairo>(width, height, pixelsImage);
+	if (cairo_surface_status(handle->surfImage.get()) != CAIRO_STATUS_SUCCESS)
+		return nullptr;
+	return handle;
+}
+
+bool SurfaceImpl::DrawImageHandle(PRectangle rc, ImageHandle *handle) {
+	ImageHandleCairo *handleCairo = dynamic_cast<ImageHandleCairo *>(handle);
+	if (!context || !handleCairo)
+		return false;
+	PaintImageSurface(context, ImageRectangle(rc, handleCairo->width, handleCairo->height), handleCairo->surfImage.get());
+	return true;
 }
 
 void SurfaceImpl::Ellipse(PRectangle rc, FillStroke fillStroke) {
@@ -770,6 +888,49 @@ size_t MultiByteLenFromIconv(const Converter &conv, const char *s, size_t len) n
 	return 1;
 }
 
+// Font options for text drawn to context: those of its target surface overridden by its own.
+UniqueCairoFontOptions ContextFontOptions(cairo_t *context) {
+	UniqueCairoFontOptions options(cairo_font_options_create());
+	cairo_surface_get_font_options(cairo_get_target(context), options.get());
+	UniqueCairoFontOptions contextOptions(cairo_font_options_create());
+	cairo_get_font_options(context, contextOptions.get());
+	cairo_font_options_merge(options.get(), contextOptions.get());
+	return options;
+}
+
+// Glyph runs from a laid out line with the resolution and font options they were shaped
+// for as they are only valid when drawn to a similar context.
+class ShapedTextPango : public ShapedText {
+public:
+	struct Run {
+		UniquePangoFont font;
+		UniquePangoGlyphString glyphs;
+		XYPOSITION x;
+	};
+	std::vector<Run> runs;
+	double resolution;
+	UniqueCairoFontOptions fontOptions;
+	ShapedTextPango(PangoLayout *layout, PangoLayoutLine *pll, cairo_t *context) :
+		resolution(pango_cairo_context_get_resolution(pango_layout_get_context(layout))),
+		fontOptions(ContextFontOptions(context)) {
+		int x = 0;
+		for (GSList *run = pll->runs; run; run = run->next) {
+			const PangoGlyphItem *item = static_cast<const PangoGlyphItem *>(run->data);
+			PangoFont *font = item->item->analysis.font;
+			g_object_ref(font);
+			runs.push_back({ UniquePangoFont(font), UniquePangoGlyphString(pango_glyph_string_copy(item->glyphs)),
+				pango_units_to_double(x) });
+			x += pango_glyph_string_get_width(item->glyphs);
+		}
+	}
+	bool Matches(PangoLayout *layout, cairo_t *context) const {
+		if (resolution != pango_cairo_context_get_resolution(pango_layout_get_context(layout)))
+			return false;
+		const UniqueCairoFontOptions options = ContextFontOptions(context);
+		return cairo_font_options_equal(fontOptions.get(), options.get());
+	}
+};
+
 }
 
 void SurfaceImpl::DrawTextBase(PRectangle rc, const Font *font_, XYPOSITION ybase, Sci::string_view text,
@@ -821,6 +982,33 @@ void SurfaceImpl::DrawTextTransparent(PRectangle rc, const Font *font_, XYPOSITI
 	}
 }
 
+std::shared_ptr<ShapedText> SurfaceImpl::ShapeText(const Font *font_, Sci::string_view text) {
+	// Other encodings would need conversion so are drawn directly.
+	if (!context || (et != EncodingType::utf8) || !PFont(font_)->fd)
+		return nullptr;
+	LayoutSetText(layout.get(), text);
+	pango_layout_set_font_description(layout.get(), PFont(font_)->fd.get());
+	pango_cairo_update_layout(context, layout.get());
+	if (pango_layout_get_line_count(layout.get()) != 1)
+		return nullptr;
+	PangoLayoutLine *pll = pango_layout_get_line_readonly(layout.get(), 0);
+	return std::make_shared<ShapedTextPango>(layout.get(), pll, context);
+}
+
+bool SurfaceImpl::DrawShapedText(PRectangle rc, const ShapedText *shaped, XYPOSITION ybase, ColourRGBA fore) {
+	const ShapedTextPango *shapedPango = dynamic_cast<const ShapedTextPango *>(shaped);
+	if (!context || !shapedPango)
+		return false;
+	if (!shapedPango->Matches(layout.get(), context))
+		return false;
+	PenColourAlpha(fore);
+	for (const ShapedTextPango::Run &run : shapedPango->runs) {
+		cairo_move_to(context, rc.left + run.x, ybase);
+		pango_cairo_show_glyph_string(context, run.font.get(), run.glyphs.get());
+	}
+	return true;
+}
+
 namespace {
 
 class ClusterIterator {
@@ -870,18 +1058,17 @@ void EquallySpaced(PangoLayout *layout, XYPOSITION *positions, size_t lenPositio
 
 void SurfaceImpl::MeasureWidths(const Font *font_, Sci::string_view text, XYPOSITION *positions) {
 	if (PFont(font_)->fd) {
-		UniquePangoContext contextMeasure = MeasuringContext();
-		UniquePangoLayout layoutMeasure(pango_layout_new(contextMeasure.get()));
+		PangoLayout *layoutMeasure = MeasuringLayout();
 		PLATFORM_ASSERT(layoutMeasure);
 
-		pango_layout_set_font_description(layoutMeasure.get(), PFont(font_)->fd.get());
+		pango_layout_set_font_description(layoutMeasure, PFont(font_)->fd.get());
 		if (et == EncodingType::utf8) {
 			// Simple and direct as UTF-8 is native Pango encoding
-			ClusterIterator iti(layoutMeasure.get(), text);
+			ClusterIterator iti(layoutMeasure, text);
 			int i = iti.curIndex;
 			if (i != 0) {
 				// Unexpected start to iteration, could be bidirectional text
-				EquallySpaced(layoutMeasure.get(), positions, text.length());
+				EquallySpaced(layoutMeasure, positions, text.length());
 				return;
 			}
 			while (!iti.finished) {
@@ -928,11 +1115,11 @@ void SurfaceImpl::MeasureWidths(const Font *font_, Sci::string_view text, XYPOSI
 					// character byte lengths.
 					Converter convMeasure("UCS-2", charSetID, false);
 					int i = 0;
-					ClusterIterator iti(layoutMeasure.get(), utfForm);
+					ClusterIterator iti(layoutMeasure, utfForm);
 					int clusterStart = iti.curIndex;
 					if (clusterStart != 0) {
 						// Unexpected start to iteration, could be bidirectional text
-						EquallySpaced(layoutMeasure.get(), positions, text.length());
+						EquallySpaced(layoutMeasure, positions, text.length());
 						return;
 					}
 					while (!iti.finished) {
@@ -967,11 +1154,11 @@ void SurfaceImpl::MeasureWidths(const Font *font_, Sci::string_view text, XYPOSI
 				size_t i = 0;
 				// Each 8-bit input character may take 1 or 2 bytes in UTF-8
 				// and groups of up to 3 may be represented as ligatures.
-				ClusterIterator iti(layoutMeasure.get(), utfForm);
+				ClusterIterator iti(layoutMeasure, utfForm);
 				int clusterStart = iti.curIndex;
 				if (clusterStart != 0) {
 					// Unexpected start to iteration, could be bidirectional text
-					EquallySpaced(layoutMeasure.get(), positions, lenPositions);
+					EquallySpaced(layoutMeasure, positions, lenPositions);
 					return;
 				}
 				while (!iti.finished) {
@@ -984,7 +1171,7 @@ void SurfaceImpl::MeasureWidths(const Font *font_, Sci::string_view text, XYPOSI
 #ifdef DEBUG
 						fprintf(stderr, "MeasureWidths: result too long.\n");
 #endif
-						EquallySpaced(layoutMeasure.get(), positions, lenPositions);
+						EquallySpaced(layoutMeasure, positions, lenPositions);
 						return;
 					}
 					PLATFORM_ASSERT(ligatureLength > 0 && ligatureLength <= 3);
@@ -1071,53 +1258,60 @@ void SurfaceImpl::DrawTextTransparentUTF8(PRectangle rc, const Font *font_, XYPO
 
 void SurfaceImpl::MeasureWidthsUTF8(const Font *font_, Sci::string_view text, XYPOSITION *positions) {
 	if (PFont(font_)->fd) {
-		UniquePangoContext contextMeasure = MeasuringContext();
-		UniquePangoLayout layoutMeasure(pango_layout_new(contextMeasure.get()));
+		PangoLayout *layoutMeasure = MeasuringLayout();
 		PLATFORM_ASSERT(layoutMeasure);
 
-		pango_layout_set_font_description(layoutMeasure.get(), PFont(font_)->fd.get());
-		// Simple and direct as UTF-8 is native Pango encoding
-		ClusterIterator iti(layoutMeasure.get(), text);
-		int i = iti.curIndex;
-		if (i != 0) {
-			// Unexpected start to iteration, could be bidirectional text
-			EquallySpaced(layoutMeasure.get(), positions, text.length());
-			return;
-		}
-		while (!iti.finished) {
-			iti.Next();
-			if (iti.curIndex < i) {
-				// Backwards movement indicater bidirectional.
-				// Divide into ASCII prefix and non-ASCII suffix as this is common case
-				// and produces accurate positions for the ASCII prefix.
-				size_t lenASCII=0;
-				while (lenASCII<text.length() && IsASCII(text[lenASCII])) {
-					lenASCII++;
+		pango_layout_set_font_description(layoutMeasure, PFont(font_)->fd.get());
+		bool bidirectional = false;
+		{
+			// Simple and direct as UTF-8 is native Pango encoding
+			ClusterIterator iti(layoutMeasure, text);
+			int i = iti.curIndex;
+			if (i != 0) {
+				// Unexpected start to iteration, could be bidirectional text
+				EquallySpaced(layoutMeasure, positions, text.length());
+				return;
+			}
+			while (!iti.finished) {
+				iti.Next();
+				if (iti.curIndex < i) {
+					// Backwards movement indicater bidirectional.
+					bidirectional = true;
+					break;
 				}
-				const Sci::string_view asciiPrefix = text.substr(0, lenASCII);
-				const Sci::string_view bidiSuffix = text.substr(lenASCII);
-				// Recurse for ASCII prefix.
-				MeasureWidthsUTF8(font_, asciiPrefix, positions);
-				// Measure the whole bidiSuffix and spread its width evenly
-				const XYPOSITION endASCII = positions[lenASCII-1];
-				const XYPOSITION widthBidi = WidthText(font_, bidiSuffix);
-				const XYPOSITION widthByteBidi = widthBidi / bidiSuffix.length();
-				for (size_t bidiPos=0; bidiPos<bidiSuffix.length(); bidiPos++) {
-					positions[bidiPos+lenASCII] = endASCII + widthByteBidi * (bidiPos + 1);
+				const int places = iti.curIndex - i;
+				while (i < iti.curIndex) {
+					// Evenly distribute space among bytes of this cluster.
+					// Would be better to find number of characters and then
+					// divide evenly between characters with each byte of a character
+					// being at the same position.
+					positions[i] = iti.position - (iti.curIndex - 1 - i) * iti.distance / places;
+					i++;
 				}
-				return;
 			}
-			const int places = iti.curIndex - i;
-			while (i < iti.curIndex) {
-				// Evenly distribute space among bytes of this cluster.
-				// Would be better to find number of characters and then
-				// divide evenly between characters with each byte of a character
-				// being at the same position.
-				positions[i] = iti.position - (iti.curIndex - 1 - i) * iti.distance / places;
-				i++;
+			PLATFORM_ASSERT(bidirectional || static_cast<size_t>(i) == text.length());
+		}
+		if (bidirectional) {
+			// The iterator has been freed as the recursive call below reuses the
+			// same pooled layout.
+			// Divide into ASCII prefix and non-ASCII suffix as this is common case
+			// and produces accurate positions for the ASCII prefix.
+			size_t lenASCII=0;
+			while (lenASCII<text.length() && IsASCII(text[lenASCII])) {
+				lenASCII++;
+			}
+			const Sci::string_view asciiPrefix = text.substr(0, lenASCII);
+			const Sci::string_view bidiSuffix = text.substr(lenASCII);
+			// Recurse for ASCII prefix.
+			MeasureWidthsUTF8(font_, asciiPrefix, positions);
+			// Measure the whole bidiSuffix and spread its width evenly
+			const XYPOSITION endASCII = positions[lenASCII-1];
+			const XYPOSITION widthBidi = WidthText(font_, bidiSuffix);
+			const XYPOSITION widthByteBidi = widthBidi / bidiSuffix.length();
+			for (size_t bidiPos=0; bidiPos<bidiSuffix.length(); bidiPos++) {
+				positions[bidiPos+lenASCII] = endASCII + widthByteBidi * (bidiPos + 1);
 			}
 		}
-		PLATFORM_ASSERT(static_cast<size_t>(i) == text.length());
 	} else {
 		// No font so return an ascending range of values
 		for (size_t i = 0; i < text.length(); i++) {
@@ -1126,6 +1320,120 @@ void SurfaceImpl::MeasureWidthsUTF8(const Font *font_, Sci::string_view text, XY
 	}
 }
 
+namespace {
+
+// Text that would add extra lines or can not be split back out of a batch layout.
+bool BreaksBatchLayout(Sci::string_view text) noexcept {
+	if (text.empty()) {
+		return true;
+	}
+	for (size_t i = 0; i < text.length(); i++) {
+		const char ch = text[i];
+		if (ch == '\n' || ch == '\r' || ch == '\0') {
+			return true;
+		}
+		// U+2028 LINE SEPARATOR and U+2029 PARAGRAPH SEPARATOR
+		if ((ch == '\xE2') && (i + 2 < text.length()) && (text[i+1] == '\x80') &&
+			((text[i+2] == '\xA8') || (text[i+2] == '\xA9'))) {
+			return true;
+		}
+	}
+	return false;
+}
+
+}
+
+// Shape all the requests in one layout with each request as a separate paragraph so
+// they do not affect each other. Returns false if the layout could not be split back
+// into the requests, such as with bidirectional text.
+bool SurfaceImpl::MeasureBatchLayout(const TextMeasureRequest *requests, size_t count) {
+	std::string text;
+	std::vector<int> starts;
+	UniquePangoAttrList attrs(pango_attr_list_new());
+	for (size_t k = 0; k < count; k++) {
+		const FontHandle *pfh = PFont(requests[k].font);
+		if (!pfh || !pfh->fd || BreaksBatchLayout(requests[k].text)) {
+			return false;
+		}
+		starts.push_back(static_cast<int>(text.length()));
+		text.append(requests[k].text.data(), requests[k].text.length());
+		PangoAttribute *attr = pango_attr_font_desc_new(pfh->fd.get());
+		attr->start_index = starts.back();
+		attr->end_index = static_cast<guint>(text.length());
+		pango_attr_list_insert(attrs.get(), attr);
+		if (k + 1 < count) {
+			text.push_back('\n');
+		}
+	}
+
+	PangoLayout *layoutMeasure = MeasuringLayout();
+	PLATFORM_ASSERT(layoutMeasure);
+	pango_layout_set_font_description(layoutMeasure, PFont(requests[0].font)->fd.get());
+	pango_layout_set_attributes(layoutMeasure, attrs.get());
+	LayoutSetText(layoutMeasure, text);
+
+	bool success = pango_layout_get_line_count(layoutMeasure) == static_cast<int>(count);
+	if (success) {
+		UniquePangoLayoutIter iter(pango_layout_get_iter(layoutMeasure));
+		for (size_t k = 0; (k < count) && success; k++) {
+			const int start = starts[k];
+			const int end = start + static_cast<int>(requests[k].text.length());
+			XYPOSITION *positions = requests[k].positions;
+			PangoLayoutLine *line = pango_layout_iter_get_line_readonly(iter.get());
+			PangoRectangle lineRect {};
+			pango_layout_iter_get_line_extents(iter.get(), nullptr, &lineRect);
+			int index = pango_layout_iter_get_index(iter.get());
+			if (index != start) {
+				success = false;
+				break;
+			}
+			bool sameLine = true;
+			while (index < end) {
+				PangoRectangle pos {};
+				pango_layout_iter_get_cluster_extents(iter.get(), nullptr, &pos);
+				const XYPOSITION xEnd = pango_units_to_double(pos.x + pos.width - lineRect.x);
+				const XYPOSITION width = pango_units_to_double(pos.width);
+				int indexNext = end;
+				if (pango_layout_iter_next_cluster(iter.get())) {
+					sameLine = pango_layout_iter_get_line_readonly(iter.get()) == line;
+					if (sameLine) {
+						indexNext = std::min(pango_layout_iter_get_index(iter.get()), end);
+					}
+				}
+				if (indexNext <= index) {
+					// Backwards movement indicates bidirectional text
+					success = false;
+					break;
+				}
+				const int places = indexNext - index;
+				for (int i = index; i < indexNext; i++) {
+					// Evenly distribute space among bytes of this cluster.
+					positions[i - start] = xEnd - (indexNext - 1 - i) * width / places;
+				}
+				index = indexNext;
+			}
+			if (success && sameLine && (k + 1 < count)) {
+				success = pango_layout_iter_next_line(iter.get());
+			}
+		}
+	}
+
+	// The pooled layout is shared with other measurement methods that set a font description
+	pango_layout_set_attributes(layoutMeasure, nullptr);
+	return success;
+}
+
+void SurfaceImpl::MeasureWidthsBatchUTF8(const TextMeasureRequest *requests, size_t count) {
+	if (count == 0) {
+		return;
+	}
+	if ((count == 1) || !MeasureBatchLayout(requests, count)) {
+		for (size_t k = 0; k < count; k++) {
+			MeasureWidthsUTF8(requests[k].font, requests[k].text, requests[k].positions);
+		}
+	}
+}
+
 XYPOSITION SurfaceImpl::WidthTextUTF8(const Font *font_, Sci::string_view text) {
 	if (PFont(font_)->fd) {
 		pango_layout_set_font_description(layout.get(), PFont(font_)->fd.get());
@@ -1408,6 +1716,52 @@ enum {
 	N_COLUMNS
 };
 
+// Items of the list stored as consecutive NUL-terminated strings so a long list is
+// a few allocations rather than one or more for each item.
+class ListItems {
+	struct Item {
+		size_t offset;
+		int type;
+	};
+	std::string text;
+	std::vector<Item> items;
+public:
+	void Clear() noexcept {
+		text.clear();
+		items.clear();
+	}
+	void Reserve(size_t lengthText) {
+		text.reserve(lengthText);
+	}
+	void Add(const char *s, size_t len, int type) {
+		items.push_back({text.length(), type});
+		text.append(s, len);
+		text.push_back('\0');
+	}
+	int Count() const noexcept {
+		return static_cast<int>(items.size());
+	}
+	const char *Text(int index) const noexcept {
+		return text.c_str() + items[index].offset;
+	}
+	int Type(int index) const noexcept {
+		return items[index].type;
+	}
+};
+
+class ListBoxX;
+
+// ListModel, a GtkTreeModel that presents the items of a ListBoxX without copying
+// them into a GtkListStore. Values are only produced for the rows the view asks for.
+typedef struct {
+	GObject parent;
+	ListBoxX *lb;
+	gint stamp;
+} ListModel;
+typedef GObjectClass ListModelClass;
+
+GtkTreeModel *list_model_new(ListBoxX *lb);
+
 class ListBoxX : public ListBox {
 	WindowID widCached;
 	WindowID frame;
@@ -1423,8 +1777,12 @@ class ListBoxX : public ListBox {
 #if GTK_CHECK_VERSION(3,0,0)
 	std::unique_ptr<GtkCssProvider, GObjectReleaser> cssProvider;
 #endif
+	ListModel *Model() const noexcept;
+	void ReplaceItems(const char *listText, char separator, char typesep);
+	void WidenForImage(int type);
 public:
 	IListBoxDelegate *delegate;
+	ListItems items;
 
 	ListBoxX() noexcept : widCached(nullptr), frame(nullptr), list(nullptr), scroller(nullptr),
 		pixhash(nullptr), pixbuf_renderer(nullptr),
@@ -1470,6 +1828,7 @@ public:
 	void SetDelegate(IListBoxDelegate *lbDelegate) override;
 	void SetList(const char *listText, char separator, char typesep) override;
 	void SetOptions(ListOptions options_) override;
+	GdkPixbuf *PixbufForType(int type);
 };
 
 std::unique_ptr<ListBox> ListBox::Allocate() {
@@ -1555,6 +1914,125 @@ static void small_scroller_class_init(SmallScrollerClass *klass) {
 
 static void small_scroller_init(SmallScroller *) {}
 
+static void list_model_tree_model_init(GtkTreeModelIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(ListModel, list_model, G_TYPE_OBJECT,
+	G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL, list_model_tree_model_init))
+
+static void list_model_class_init(ListModelClass *) {}
+
+static void list_model_init(ListModel *model) {
+	model->lb = nullptr;
+	model->stamp = g_random_int();
+}
+
+GtkTreeModel *list_model_new(ListBoxX *lb) {
+	ListModel *model = static_cast<ListModel *>(g_object_new(list_model_get_type(), nullptr));
+	model->lb = lb;
+	return GTK_TREE_MODEL(model);
+}
+
+static ListModel *AsListModel(GtkTreeModel *tree_model) noexcept {
+	return reinterpret_cast<ListModel *>(tree_model);
+}
+
+// Rows are identified by their index which is held directly in the iterator.
+static gboolean list_model_set_iter(ListModel *model, GtkTreeIter *iter, int index) noexcept {
+	if ((index < 0) || (index >= model->lb->items.Count())) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	iter->stamp = model->stamp;
+	iter->user_data = GINT_TO_POINTER(index);
+	return TRUE;
+}
+
+static int list_model_index(const GtkTreeIter *iter) noexcept {
+	return GPOINTER_TO_INT(iter->user_data);
+}
+
+static GtkTreeModelFlags list_model_get_flags(GtkTreeModel *) {
+	return static_cast<GtkTreeModelFlags>(GTK_TREE_MODEL_LIST_ONLY | GTK_TREE_MODEL_ITERS_PERSIST);
+}
+
+static gint list_model_get_n_columns(GtkTreeModel *) {
+	return N_COLUMNS;
+}
+
+static GType list_model_get_column_type(GtkTreeModel *, gint index) {
+	return (index == PIXBUF_COLUMN) ? GDK_TYPE_PIXBUF : G_TYPE_STRING;
+}
+
+static gboolean list_model_get_iter(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreePath *path) {
+	if (gtk_tree_path_get_depth(path) != 1)
+		return FALSE;
+	return list_model_set_iter(AsListModel(tree_model), iter, gtk_tree_path_get_indices(path)[0]);
+}
+
+static GtkTreePath *list_model_get_path(GtkTreeModel *, GtkTreeIter *iter) {
+	return gtk_tree_path_new_from_indices(list_model_index(iter), -1);
+}
+
+static void list_model_get_value(GtkTreeModel *tree_model, GtkTreeIter *iter, gint column, GValue *value) {
+	ListModel *model = AsListModel(tree_model);
+	const int index = list_model_index(iter);
+	if (column == PIXBUF_COLUMN) {
+		g_value_init(value, GDK_TYPE_PIXBUF);
+		g_value_set_object(value, model->lb->PixbufForType(model->lb->items.Type(index)));
+	} else {
+		g_value_init(value, G_TYPE_STRING);
+		g_value_set_string(value, model->lb->items.Text(index));
+	}
+}
+
+static gboolean list_model_iter_next(GtkTreeModel *tree_model, GtkTreeIter *iter) {
+	return list_model_set_iter(AsListModel(tree_model), iter, list_model_index(iter) + 1);
+}
+
+static gboolean list_model_iter_children(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *parent) {
+	if (parent) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	return list_model_set_iter(AsListModel(tree_model), iter, 0);
+}
+
+static gboolean list_model_iter_has_child(GtkTreeModel *, GtkTreeIter *) {
+	return FALSE;
+}
+
+static gint list_model_iter_n_children(GtkTreeModel *tree_model, GtkTreeIter *iter) {
+	return iter ? 0 : AsListModel(tree_model)->lb->items.Count();
+}
+
+static gboolean list_model_iter_nth_child(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *parent, gint n) {
+	if (parent) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	return list_model_set_iter(AsListModel(tree_model), iter, n);
+}
+
+static gboolean list_model_iter_parent(GtkTreeModel *, GtkTreeIter *iter, GtkTreeIter *) {
+	iter->stamp = 0;
+	return FALSE;
+}
+
+static void list_model_tree_model_init(GtkTreeModelIface *iface) {
+	iface->get_flags = list_model_get_flags;
+	iface->get_n_columns = list_model_get_n_columns;
+	iface->get_column_type = list_model_get_column_type;
+	iface->get_iter = list_model_get_iter;
+	iface->get_path = list_model_get_path;
+	iface->get_value = list_model_get_value;
+	iface->iter_next = list_model_iter_next;
+	iface->iter_children = list_model_iter_children;
+	iface->iter_has_child = list_model_iter_has_child;
+	iface->iter_n_children = list_model_iter_n_children;
+	iface->iter_nth_child = list_model_iter_nth_child;
+	iface->iter_parent = list_model_iter_parent;
+}
+
 static gboolean ButtonPress(GtkWidget *, const GdkEventButton *ev, gpointer p) {
 	try {
 		ListBoxX *lb = static_cast<ListBoxX *>(p);
@@ -1663,10 +2141,10 @@ void ListBoxX::Create(Window &parent, int, Point, int, bool, Technology) {
 	gtk_widget_show(PWidget(scroller));
 
 	/* Tree and its model */
-	GtkListStore *store =
-		gtk_list_store_new(N_COLUMNS, GDK_TYPE_PIXBUF, G_TYPE_STRING);
+	GtkTreeModel *model = list_model_new(this);
 
-	list = gtk_tree_view_new_with_model(GTK_TREE_MODEL(store));
+	list = gtk_tree_view_new_with_model(model);
+	g_object_unref(model);
 	g_signal_connect(G_OBJECT(list), "style-set", G_CALLBACK(StyleSet), nullptr);
 
 #if GTK_CHECK_VERSION(3,0,0)
@@ -1866,9 +2344,53 @@ int ListBoxX::CaretFromEdge() {
 	return 4 + renderer_width;
 }
 
+ListModel *ListBoxX::Model() const noexcept {
+	return reinterpret_cast<ListModel *>(gtk_tree_view_get_model(GTK_TREE_VIEW(list)));
+}
+
+// Signalling the deletion and insertion of each row is slow for long lists so the model
+// is detached from the view while its items are replaced.
+void ListBoxX::ReplaceItems(const char *listText, char separator, char typesep) {
+	ListModel *model = Model();
+	g_object_ref(model);
+	gtk_tree_view_set_model(GTK_TREE_VIEW(list), nullptr);
+	// Invalidate any iterators into the old items
+	model->stamp++;
+	items.Clear();
+	maxItemCharacters = 0;
+	if (listText) {
+		items.Reserve(strlen(listText));
+		std::set<int> types;
+		const char *startword = listText;
+		const char *numword = nullptr;
+		for (const char *pc = listText;; pc++) {
+			if ((*pc == separator) || (*pc == '\0')) {
+				const size_t len = (numword ? numword : pc) - startword;
+				const int type = numword ? atoi(numword + 1) : -1;
+				items.Add(startword, len, type);
+				types.insert(type);
+				if (maxItemCharacters < len)
+					maxItemCharacters = static_cast<unsigned int>(len);
+				if (*pc == '\0')
+					break;
+				startword = pc + 1;
+				numword = nullptr;
+			} else if (*pc == typesep) {
+				numword = pc;
+			}
+		}
+		for (const int type : types) {
+			WidenForImage(type);
+		}
+	}
+	gtk_tree_view_set_model(GTK_TREE_VIEW(list), GTK_TREE_MODEL(model));
+	g_object_unref(model);
+}
+
 void ListBoxX::Clear() noexcept {
-	GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(list));
-	gtk_list_store_clear(GTK_LIST_STORE(model));
+	if (list) {
+		ReplaceItems(nullptr, '\0', '\0');
+	}
 	maxItemCharacters = 0;
 }
 
@@ -1892,48 +2414,49 @@ static void init_pixmap(ListImage *list_image) noexcept {
 
 #define SPACING 5
 
-void ListBoxX::Append(char *s, int type) {
-	ListImage *list_image = nullptr;
-	if ((type >= 0) && pixhash) {
-		list_image = static_cast<ListImage *>(g_hash_table_lookup(pixhash,
-						      GINT_TO_POINTER(type)));
+GdkPixbuf *ListBoxX::PixbufForType(int type) {
+	if ((type < 0) || !pixhash)
+		return nullptr;
+	ListImage *list_image = static_cast<ListImage *>(g_hash_table_lookup(pixhash,
+					      GINT_TO_POINTER(type)));
+	if (!list_image)
+		return nullptr;
+	if (nullptr == list_image->pixbuf)
+		init_pixmap(list_image);
+	return list_image->pixbuf;
+}
+
+void ListBoxX::WidenForImage(int type) {
+	GdkPixbuf *pixbuf = PixbufForType(type);
+	if (pixbuf) {
+		const gint pixbuf_width = gdk_pixbuf_get_width(pixbuf);
+		gint renderer_height, renderer_width;
+		gtk_cell_renderer_get_fixed_size(pixbuf_renderer,
+						 &renderer_width, &renderer_height);
+		if (pixbuf_width > renderer_width)
+			gtk_cell_renderer_set_fixed_size(pixbuf_renderer,
+							 pixbuf_width, -1);
 	}
+}
+
+void ListBoxX::Append(char *s, int type) {
+	const size_t len = strlen(s);
+	items.Add(s, len, type);
+	WidenForImage(type);
+	ListModel *model = Model();
+	const int index = items.Count() - 1;
 	GtkTreeIter iter {};
-	GtkListStore *store =
-		GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(list)));
-	gtk_list_store_append(GTK_LIST_STORE(store), &iter);
-	if (list_image) {
-		if (nullptr == list_image->pixbuf)
-			init_pixmap(list_image);
-		if (list_image->pixbuf) {
-			gtk_list_store_set(GTK_LIST_STORE(store), &iter,
-					   PIXBUF_COLUMN, list_image->pixbuf,
-					   TEXT_COLUMN, s, -1);
-
-			const gint pixbuf_width = gdk_pixbuf_get_width(list_image->pixbuf);
-			gint renderer_height, renderer_width;
-			gtk_cell_renderer_get_fixed_size(pixbuf_renderer,
-							 &renderer_width, &renderer_height);
-			if (pixbuf_width > renderer_width)
-				gtk_cell_renderer_set_fixed_size(pixbuf_renderer,
-								 pixbuf_width, -1);
-		} else {
-			gtk_list_store_set(GTK_LIST_STORE(store), &iter,
-					   TEXT_COLUMN, s, -1);
-		}
-	} else {
-		gtk_list_store_set(GTK_LIST_STORE(store), &iter,
-				   TEXT_COLUMN, s, -1);
-	}
-	const unsigned int len = static_cast<unsigned int>(strlen(s));
+	list_model_set_iter(model, &iter, index);
+	GtkTreePath *path = gtk_tree_path_new_from_indices(index, -1);
+	gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &iter);
+	gtk_tree_path_free(path);
 	if (maxItemCharacters < len)
-		maxItemCharacters = len;
+		maxItemCharacters = static_cast<unsigned int>(len);
 }
 
 int ListBoxX::Length() {
 	if (wid)
-		return gtk_tree_model_iter_n_children(gtk_tree_view_get_model
-						      (GTK_TREE_VIEW(list)), nullptr);
+		return items.Count();
 	return 0;
 }
 
@@ -2009,39 +2532,20 @@ int ListBoxX::GetSelection() {
 }
 
 int ListBoxX::Find(const char *prefix) {
-	GtkTreeIter iter {};
-	GtkTreeModel *model =
-		gtk_tree_view_get_model(GTK_TREE_VIEW(list));
-	bool valid = gtk_tree_model_get_iter_first(model, &iter) != FALSE;
-	int i = 0;
-	while (valid) {
-		gchar *s = nullptr;
-		gtk_tree_model_get(model, &iter, TEXT_COLUMN, &s, -1);
-		if (s && (0 == strncmp(prefix, s, strlen(prefix)))) {
-			g_free(s);
+	const size_t lenPrefix = strlen(prefix);
+	for (int i = 0; i < items.Count(); i++) {
+		if (0 == strncmp(prefix, items.Text(i), lenPrefix)) {
 			return i;
 		}
-		g_free(s);
-		valid = gtk_tree_model_iter_next(model, &iter) != FALSE;
-		i++;
 	}
 	return -1;
 }
 
 std::string ListBoxX::GetValue(int n) {
-	char *text = nullptr;
-	GtkTreeIter iter {};
-	GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(list));
-	const bool valid = gtk_tree_model_iter_nth_child(model, &iter, nullptr, n) != FALSE;
-	if (valid) {
-		gtk_tree_model_get(model, &iter, TEXT_COLUMN, &text, -1);
-	}
-	std::string value;
-	if (text) {
-		value = text;
+	if ((n >= 0) && (n < items.Count())) {
+		return items.Text(n);
 	}
-	g_free(text);
-	return value;
+	return std::string();
 }
 
 // g_return_if_fail causes unnecessary compiler warning in release compile.
@@ -2091,29 +2595,7 @@ void ListBoxX::SetDelegate(IListBoxDelegate *lbDelegate) {
 }
 
 void ListBoxX::SetList(const char *listText, char separator, char typesep) {
-	Clear();
-	const size_t count = strlen(listText) + 1;
-	std::vector<char> words(listText, listText+count);
-	char *startword = &words[0];
-	char *numword = nullptr;
-	int i = 0;
-	for (; words[i]; i++) {
-		if (words[i] == separator) {
-			words[i] = '\0';
-			if (numword)
-				*numword = '\0';
-			Append(startword, numword?atoi(numword + 1):-1);
-			startword = &words[0] + i + 1;
-			numword = nullptr;
-		} else if (words[i] == typesep) {
-			numword = &words[0] + i;
-		}
-	}
-	if (startword) {
-		if (numword)
-			*numword = '\0';
-		Append(startword, numword?atoi(numword + 1):-1);
-	}
+	ReplaceItems(listText, separator, typesep);
 }
 
 void ListBoxX::SetOptions(ListOptions) {
@@ -903,6 +903,7 @@ sptr_t ScintillaGTK::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 			return reinterpret_cast<sptr_t>(this);
 
 		case Message::TargetAsUTF8:
+			CommitAppended();
 			return TargetAsUTF8(CharPtrFromSPtr(lParam));
 
 		case Message::EncodedFromUTF8:
@@ -1339,6 +1340,119 @@ int ScintillaGTK::KeyDefault(Keys key, KeyMod modifiers) {
 	return 0;
 }
 
+namespace {
+
+// Stream selections at least this long are read from the document when the clipboard is
+// asked for them instead of when copied, so copying does not stall or duplicate the text.
+constexpr Sci::Position deferredCopyMinimum = 1024 * 1024;
+
+// The text of a large copy, still in its document until requested. The document is watched
+// so a snapshot can be taken just before the copied range changes. Changes before the range
+// move it and changes after it are ignored.
+// The watcher can not be removed while the document is notifying watchers so, after the
+// snapshot, the document is released from an idle callback or when the clipboard is cleared.
+class DeferredCopy : public DocWatcher {
+	Document *pdoc;
+	Sci::Position start;
+	Sci::Position end;
+	int codePage;
+	CharacterSet characterSet;
+	bool detached;
+	guint detachIdleID;
+	void Detach() {
+		if (detachIdleID) {
+			g_source_remove(detachIdleID);
+			detachIdleID = 0;
+		}
+		if (pdoc) {
+			pdoc->RemoveWatcher(this, nullptr);
+			pdoc->Release();
+			pdoc = nullptr;
+		}
+	}
+	static gboolean DetachOnIdle(gpointer data) {
+		DeferredCopy *deferred = static_cast<DeferredCopy *>(data);
+		deferred->detachIdleID = 0;
+		deferred->Detach();
+		// Returning FALSE removes the source
+		return FALSE;
+	}
+	std::string Text() const {
+		// Read in chunks, replacing NULs as SelectionText does while each chunk is in cache.
+		constexpr Sci::Position chunkSize = 0x10000;
+		std::string text(end - start, '\0');
+		for (Sci::Position position = start; position < end; position += chunkSize) {
+			const Sci::Position lengthChunk = std::min(chunkSize, end - position);
+			char *chunk = &text[position - start];
+			pdoc->GetCharRange(chunk, position, lengthChunk);
+			std::replace(chunk, chunk + lengthChunk, '\0', ' ');
+		}
+		return text;
+	}
+	void DetachWithSnapshot() {
+		// Only snapshot now as the watcher can not be removed during notification
+		snapshot.Copy(Text(), codePage, characterSet, false, false);
+		detached = true;
+		detachIdleID = gdk_threads_add_idle_full(G_PRIORITY_DEFAULT_IDLE, DetachOnIdle, this, nullptr);
+	}
+public:
+	SelectionText snapshot;
+	DeferredCopy(Document *pdoc_, Sci::Position start_, Sci::Position end_, CharacterSet characterSet_) :
+		pdoc(pdoc_), start(start_), end(end_), codePage(pdoc_->dbcsCodePage), characterSet(characterSet_),
+		detached(false), detachIdleID(0) {
+		pdoc->AddRef();
+		pdoc->AddWatcher(this, nullptr);
+	}
+	// Deleted so DeferredCopy objects can not be copied.
+	DeferredCopy(const DeferredCopy &) = delete;
+	DeferredCopy(DeferredCopy &&) = delete;
+	DeferredCopy &operator=(const DeferredCopy &) = delete;
+	DeferredCopy &operator=(DeferredCopy &&) = delete;
+	~DeferredCopy() override {
+		Detach();
+	}
+	// Fill text from the document or from the snapshot if the document has changed.
+	void Retrieve(SelectionText &text) const {
+		if (detached) {
+			text.Copy(snapshot);
+		} else {
+			text.Copy(Text(), codePage, characterSet, false, false);
+		}
+	}
+	void NotifyModifyAttempt(Document *, void *) override {}
+	void NotifySavePoint(Document *, void *, bool) override {}
+	void NotifyModified(Document *, DocModification mh, void *) override {
+		if (detached) {
+			return;
+		}
+		if (FlagSet(mh.modificationType, ModificationFlags::BeforeInsert)) {
+			if ((mh.position > start) && (mh.position < end)) {
+				DetachWithSnapshot();
+			}
+		} else if (FlagSet(mh.modificationType, ModificationFlags::BeforeDelete)) {
+			if ((mh.position < end) && (mh.position + mh.length > start)) {
+				DetachWithSnapshot();
+			}
+		} else if (FlagSet(mh.modificationType, ModificationFlags::InsertText)) {
+			// Text inserted before the range moves it
+			if (mh.position <= start) {
+				start += mh.length;
+				end += mh.length;
+			}
+		} else if (FlagSet(mh.modificationType, ModificationFlags::DeleteText)) {
+			if (mh.position < start) {
+				start -= mh.length;
+				end -= mh.length;
+			}
+		}
+	}
+	void NotifyDeleted(Document *, void *) noexcept override {}
+	void NotifyStyleNeeded(Document *, void *, Sci::Position) override {}
+	void NotifyErrorOccurred(Document *, void *, Status) override {}
+};
+
+}
+
 void ScintillaGTK::CopyToClipboard(const SelectionText &selectedText) {
 	SelectionText *clipText = new SelectionText();
 	clipText->Copy(selectedText);
@@ -1347,9 +1461,15 @@ void ScintillaGTK::CopyToClipboard(const SelectionText &selectedText) {
 
 void ScintillaGTK::Copy() {
 	if (!sel.Empty()) {
-		SelectionText *clipText = new SelectionText();
-		CopySelectionRange(clipText);
-		StoreOnClipboard(clipText);
+		const SelectionRange rangeMain = sel.RangeMain();
+		if ((sel.selType == Selection::SelTypes::stream) && (sel.Count() == 1) &&
+			(rangeMain.Length() >= deferredCopyMinimum)) {
+			StoreDeferredOnClipboard(rangeMain.Start().Position(), rangeMain.End().Position());
+		} else {
+			SelectionText *clipText = new SelectionText();
+			CopySelectionRange(clipText);
+			StoreOnClipboard(clipText);
+		}
 #if PLAT_GTK_WIN32
 		if (sel.IsRectangular()) {
 			::OpenClipboard(NULL);
@@ -1666,7 +1786,7 @@ void ScintillaGTK::GetSelection(GtkSelectionData *selection_data, guint info, Se
 	{
 		std::string tmpstr = Document::TransformLineEnds(text->Data(), text->Length(), EndOfLine::Lf);
 		newline_normalized = Sci::make_unique<SelectionText>();
-		newline_normalized->Copy(tmpstr, CpUtf8, CharacterSet::Ansi, text->rectangular, false);
+		newline_normalized->Copy(std::move(tmpstr), CpUtf8, CharacterSet::Ansi, text->rectangular, false);
 		text = newline_normalized.get();
 	}
 #endif
@@ -1678,7 +1798,7 @@ void ScintillaGTK::GetSelection(GtkSelectionData *selection_data, guint info, Se
 		if (*charSet) {
 			std::string tmputf = ConvertText(text->Data(), text->Length(), "UTF-8", charSet, false);
 			converted = Sci::make_unique<SelectionText>();
-			converted->Copy(tmputf, CpUtf8, CharacterSet::Ansi, text->rectangular, false);
+			converted->Copy(std::move(tmputf), CpUtf8, CharacterSet::Ansi, text->rectangular, false);
 			text = converted.get();
 		}
 	}
@@ -1718,6 +1838,33 @@ void ScintillaGTK::StoreOnClipboard(SelectionText *clipText) {
 	}
 }
 
+void ScintillaGTK::StoreDeferredOnClipboard(Sci::Position start, Sci::Position end) {
+	GtkClipboard *clipBoard =
+		gtk_widget_get_clipboard(GTK_WIDGET(PWidget(wMain)), GDK_SELECTION_CLIPBOARD);
+	if (clipBoard == nullptr) // Occurs if widget isn't in a toplevel
+		return;
+
+	DeferredCopy *deferred = new DeferredCopy(pdoc, start, end, vs.styles[StyleDefault].characterSet);
+	if (gtk_clipboard_set_with_data(clipBoard, clipboardCopyTargets, nClipboardCopyTargets,
+					ClipboardGetDeferred, ClipboardClearDeferred, deferred)) {
+		gtk_clipboard_set_can_store(clipBoard, clipboardCopyTargets, nClipboardCopyTargets);
+	} else {
+		delete deferred;
+	}
+}
+
+void ScintillaGTK::ClipboardGetDeferred(GtkClipboard *, GtkSelectionData *selection_data, guint info, void *data) {
+	// Text is only held while being handed to GTK so the document is not duplicated for long.
+	SelectionText text;
+	static_cast<const DeferredCopy *>(data)->Retrieve(text);
+	GetSelection(selection_data, info, &text);
+}
+
+void ScintillaGTK::ClipboardClearDeferred(GtkClipboard *, void *data) {
+	DeferredCopy *deferred = static_cast<DeferredCopy *>(data);
+	delete deferred;
+}
+
 void ScintillaGTK::ClipboardGetSelection(GtkClipboard *, GtkSelectionData *selection_data, guint info, void *data) {
 	GetSelection(selection_data, info, static_cast<SelectionText *>(data));
 }
@@ -168,6 +168,9 @@ private:
 	void StoreOnClipboard(SelectionText *clipText);
 	static void ClipboardGetSelection(GtkClipboard *clip, GtkSelectionData *selection_data, guint info, void *data);
 	static void ClipboardClearSelection(GtkClipboard *clip, void *data);
+	void StoreDeferredOnClipboard(Sci::Position start, Sci::Position end);
+	static void ClipboardGetDeferred(GtkClipboard *clip, GtkSelectionData *selection_data, guint info, void *data);
+	static void ClipboardClearDeferred(GtkClipboard *clip, void *data);
 
 	void ClearPrimarySelection();
 	void PrimaryGetSelectionThis(GtkClipboard *clip, GtkSelectionData *selection_data, guint info);
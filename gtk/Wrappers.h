@@ -51,6 +51,14 @@ struct FontMetricsReleaser {
 
 using UniquePangoFontMetrics = std::unique_ptr<PangoFontMetrics, FontMetricsReleaser>;
 
+struct AttrListReleaser {
+	void operator()(PangoAttrList *attrList) noexcept {
+		pango_attr_list_unref(attrList);
+	}
+};
+
+using UniquePangoAttrList = std::unique_ptr<PangoAttrList, AttrListReleaser>;
+
 struct LayoutIterReleaser {
 	// Called by unique_ptr to destroy/free the object
 	void operator()(PangoLayoutIter *iter) noexcept {
@@ -60,6 +68,15 @@ struct LayoutIterReleaser {
 
 using UniquePangoLayoutIter = std::unique_ptr<PangoLayoutIter, LayoutIterReleaser>;
 
+struct GlyphStringReleaser {
+	void operator()(PangoGlyphString *glyphs) noexcept {
+		pango_glyph_string_free(glyphs);
+	}
+};
+
+using UniquePangoGlyphString = std::unique_ptr<PangoGlyphString, GlyphStringReleaser>;
+using UniquePangoFont = std::unique_ptr<PangoFont, GObjectReleaser>;
+
 // Cairo
 
 struct CairoReleaser {
@@ -78,6 +95,14 @@ struct CairoSurfaceReleaser {
 
 using UniqueCairoSurface = std::unique_ptr<cairo_surface_t, CairoSurfaceReleaser>;
 
+struct CairoFontOptionsReleaser {
+	void operator()(cairo_font_options_t *options) noexcept {
+		cairo_font_options_destroy(options);
+	}
+};
+
+using UniqueCairoFontOptions = std::unique_ptr<cairo_font_options_t, CairoFontOptionsReleaser>;
+
 // GTK
 
 using UniqueIMContext = std::unique_ptr<GtkIMContext, GObjectReleaser>;
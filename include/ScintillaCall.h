@@ -422,6 +422,9 @@ public:
 	Position ReplaceTarget(Position length, const char *text);
 	Position ReplaceTargetRE(Position length, const char *text);
 	Position ReplaceTargetMinimal(Position length, const char *text);
+	Position ReplaceTargetDiff(Position length, const char *text);
+	void SetReplaceAllSearch(Position length, const char *text);
+	Position ReplaceAllInTarget(Position length, const char *text);
 	Position SearchInTarget(Position length, const char *text);
 	void SetSearchFlags(Scintilla::FindOption searchFlags);
 	Scintilla::FindOption SearchFlags();
@@ -488,10 +491,18 @@ public:
 	Scintilla::WrapIndentMode WrapIndentMode();
 	void SetLayoutCache(Scintilla::LineCache cacheMode);
 	Scintilla::LineCache LayoutCache();
+	void SetLayoutCacheBudget(Position bytes);
+	Position LayoutCacheBudget();
+	void SetLayoutCacheCompact(bool compact);
+	bool LayoutCacheCompact();
+	Position LayoutCacheHits();
+	Position LayoutCacheMisses();
 	void SetScrollWidth(int pixelWidth);
 	int ScrollWidth();
 	void SetScrollWidthTracking(bool tracking);
 	bool ScrollWidthTracking();
+	void SetScrollWidthExact(bool exact);
+	bool ScrollWidthExact();
 	int TextWidth(int style, const char *text);
 	void SetEndAtLastLine(bool endAtLastLine);
 	bool EndAtLastLine();
@@ -499,6 +510,9 @@ public:
 	void SetVScrollBar(bool visible);
 	bool VScrollBar();
 	void AppendText(Position length, const char *text);
+	void AppendTextDeferred(Position length, const char *text);
+	void SetAppendLineLimit(Line lines);
+	Line AppendLineLimit();
 	Scintilla::PhasesDraw PhasesDraw();
 	void SetPhasesDraw(Scintilla::PhasesDraw phases);
 	void SetFontQuality(Scintilla::FontQuality fontQuality);
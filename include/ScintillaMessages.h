@@ -343,6 +343,9 @@ enum class Message {
 	ReplaceTarget = 2194,
 	ReplaceTargetRE = 2195,
 	ReplaceTargetMinimal = 2779,
+	ReplaceTargetDiff = 2816,
+	SetReplaceAllSearch = 2828,
+	ReplaceAllInTarget = 2815,
 	SearchInTarget = 2197,
 	SetSearchFlags = 2198,
 	GetSearchFlags = 2199,
@@ -408,10 +411,18 @@ enum class Message {
 	GetWrapIndentMode = 2473,
 	SetLayoutCache = 2272,
 	GetLayoutCache = 2273,
+	SetLayoutCacheBudget = 2820,
+	GetLayoutCacheBudget = 2821,
+	SetLayoutCacheCompact = 2824,
+	GetLayoutCacheCompact = 2825,
+	GetLayoutCacheHits = 2822,
+	GetLayoutCacheMisses = 2823,
 	SetScrollWidth = 2274,
 	GetScrollWidth = 2275,
 	SetScrollWidthTracking = 2516,
 	GetScrollWidthTracking = 2517,
+	SetScrollWidthExact = 2826,
+	GetScrollWidthExact = 2827,
 	TextWidth = 2276,
 	SetEndAtLastLine = 2277,
 	GetEndAtLastLine = 2278,
@@ -419,6 +430,9 @@ enum class Message {
 	SetVScrollBar = 2280,
 	GetVScrollBar = 2281,
 	AppendText = 2282,
+	AppendTextDeferred = 2817,
+	SetAppendLineLimit = 2818,
+	GetAppendLineLimit = 2819,
 	GetPhasesDraw = 2673,
 	SetPhasesDraw = 2674,
 	SetFontQuality = 2611,
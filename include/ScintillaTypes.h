@@ -376,6 +376,7 @@ enum class LineCache {
 	Caret = 1,
 	Page = 2,
 	Document = 3,
+	Budget = 4,
 };
 
 enum class PhasesDraw {
@@ -545,6 +546,7 @@ enum class Supports {
 	TranslucentStroke = 3,
 	PixelModification = 4,
 	ThreadSafeMeasureWidths = 5,
+	ShapedText = 6,
 };
 
 enum class LineCharacterIndexType {
@@ -687,6 +689,7 @@ enum class Notification {
 	AutoCCompleted = 2030,
 	MarginRightClick = 2031,
 	AutoCSelectionChange = 2032,
+	WrapProgress = 2033,
 };
 //--Autogenerated -- end of section automatically generated from Scintilla.iface
 
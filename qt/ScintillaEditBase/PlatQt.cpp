@@ -9,6 +9,7 @@
 // Scintilla platform layer for Qt
 
 #include <cstdio>
+#include <cstring>
 
 #include "PlatQt.h"
 #include "Scintilla.h"
@@ -21,6 +22,7 @@
 #include <QScreen>
 #endif
 #include <QFont>
+#include <QFontMetricsF>
 #include <QColor>
 #include <QRect>
 #include <QPaintDevice>
@@ -139,7 +141,58 @@ static QFont::Stretch QStretchFromFontStretch(Scintilla::FontStretch stretch)
 	}
 }
 
+// Measurement lays out text with a QTextLayout retained by each font for the device
+// resolution last measured with instead of constructing a layout for every call.
+// The text last laid out is remembered so measuring identical text again, as happens when
+// a segment too long for the position cache is re-measured, skips decoding and shaping.
+// Measuring is only performed on the GUI thread as ThreadSafeMeasureWidths is not declared.
+class MeasuringLayout {
+	QTextLayout layout;
+	QTextLine line;
+	// Encoding of text: nullptr for UTF-8 decoded by QString::fromUtf8 otherwise a codec name.
+	const char *encoding = nullptr;
+	QTextCodec *codec = nullptr;
+	std::string text;
+	bool SameText(const char *encoding_, Sci::string_view sv) const noexcept {
+		return line.isValid() && (encoding_ == encoding) && (sv.length() == text.length()) &&
+			(std::memcmp(sv.data(), text.data(), sv.length()) == 0);
+	}
+public:
+	const int dpiX;
+	const int dpiY;
+	// QFont(font, device) gives the same device-specific font as QTextLayout(text, font, device).
+	MeasuringLayout(const QFont &font, QPaintDevice *device, int dpiX_, int dpiY_) :
+		layout(QString(), device ? QFont(font, device) : font),
+		dpiX(dpiX_), dpiY(dpiY_) {
+	}
+	// Lay out text in the given encoding on a single line.
+	const QTextLine &Line(const char *encoding_, Sci::string_view sv) {
+		if (!SameText(encoding_, sv)) {
+			if (encoding_ && (encoding_ != encoding)) {
+				codec = QTextCodec::codecForName(encoding_);
+			}
+			encoding = encoding_;
+			text.assign(sv.data(), sv.length());
+			const int length = static_cast<int>(sv.length());
+			layout.setText(encoding ? codec->toUnicode(sv.data(), length) : QString::fromUtf8(sv.data(), length));
+			layout.beginLayout();
+			line = layout.createLine();
+			layout.endLayout();
+		}
+		return line;
+	}
+	int TextLength() const {
+		return layout.text().size();
+	}
+};
+
 class FontAndCharacterSet : public Font {
+	// QFontMetricsF and QTextLayout are costly to construct so retain one of each for
+	// the most recent device resolution.
+	mutable std::unique_ptr<QFontMetricsF> metrics;
+	mutable int metricsDpiX = 0;
+	mutable int metricsDpiY = 0;
+	mutable std::unique_ptr<MeasuringLayout> measuring;
 public:
 	CharacterSet characterSet = CharacterSet::Ansi;
 	std::unique_ptr<QFont> pfont;
@@ -152,6 +205,25 @@ public:
 		pfont->setStretch(QStretchFromFontStretch(fp.stretch));
 		pfont->setItalic(fp.italic);
 	}
+	QFontMetricsF Metrics(QPaintDevice *device) const {
+		const int dpiX = device ? device->logicalDpiX() : 0;
+		const int dpiY = device ? device->logicalDpiY() : 0;
+		if (!metrics || (dpiX != metricsDpiX) || (dpiY != metricsDpiY)) {
+			metrics = Sci::make_unique<QFontMetricsF>(*pfont, device);
+			metricsDpiX = dpiX;
+			metricsDpiY = dpiY;
+		}
+		// Copies share the underlying font data so are cheap.
+		return *metrics;
+	}
+	MeasuringLayout &Measuring(QPaintDevice *device) const {
+		const int dpiX = device ? device->logicalDpiX() : 0;
+		const int dpiY = device ? device->logicalDpiY() : 0;
+		if (!measuring || (dpiX != measuring->dpiX) || (dpiY != measuring->dpiY)) {
+			measuring = Sci::make_unique<MeasuringLayout>(*pfont, device, dpiX, dpiY);
+		}
+		return *measuring;
+	}
 };
 
 namespace {
@@ -161,6 +233,8 @@ const Supports SupportsQt[] = {
 	Supports::FractionalStrokeWidth,
 	Supports::TranslucentStroke,
 	Supports::PixelModification,
+	// ThreadSafeMeasureWidths is not declared as measuring uses the widget's paint
+	// device for resolution and font construction which is not safe off the GUI thread.
 };
 
 const FontAndCharacterSet *AsFontAndCharacterSet(const Font *f) {
@@ -586,14 +660,13 @@ void SurfaceImpl::MeasureWidths(const Font *font,
 {
 	if (!font)
 		return;
-	SetCodec(font);
-	QString su = UnicodeFromText(codec, text);
-	QTextLayout tlay(su, *FontPointer(font), GetPaintDevice());
-	tlay.beginLayout();
-	QTextLine tl = tlay.createLine();
-	tlay.endLayout();
+	// The font's measuring layout decodes with the codec so SetCodec is not needed.
+	const char *csid = (mode.codePage == SC_CP_UTF8) ? "UTF-8" :
+		CharacterSetID(AsFontAndCharacterSet(font)->characterSet);
+	MeasuringLayout &ml = AsFontAndCharacterSet(font)->Measuring(GetPaintDevice());
+	const QTextLine &tl = ml.Line(csid, text);
 	if (mode.codePage == SC_CP_UTF8) {
-		int fit = su.size();
+		int fit = ml.TextLength();
 		int ui=0;
 		size_t i=0;
 		while (ui<fit) {
@@ -633,7 +706,7 @@ void SurfaceImpl::MeasureWidths(const Font *font,
 
 XYPOSITION SurfaceImpl::WidthText(const Font *font, Sci::string_view text)
 {
-	QFontMetricsF metrics(*FontPointer(font), device);
+	const QFontMetricsF metrics = AsFontAndCharacterSet(font)->Metrics(device);
 	SetCodec(font);
 	QString su = UnicodeFromText(codec, text);
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -685,25 +758,19 @@ void SurfaceImpl::DrawTextTransparentUTF8(PRectangle rc,
 	GetPainter()->drawText(QPointF(rc.left, ybase), su);
 }
 
-void SurfaceImpl::MeasureWidthsUTF8(const Font *font,
-				Sci::string_view text,
-				XYPOSITION *positions)
+namespace {
+
+// Set positions for each byte of UTF-8 text laid out in tl starting at UTF-16 index uiStart.
+void PositionsFromLineUTF8(const QTextLine &tl, int uiStart, qreal xStart,
+	Sci::string_view text, int fit, XYPOSITION *positions)
 {
-	if (!font)
-		return;
-	QString su = QString::fromUtf8(text.data(), static_cast<int>(text.length()));
-	QTextLayout tlay(su, *FontPointer(font), GetPaintDevice());
-	tlay.beginLayout();
-	QTextLine tl = tlay.createLine();
-	tlay.endLayout();
-	int fit = su.size();
 	int ui=0;
 	size_t i=0;
 	while (ui<fit) {
 		const unsigned char uch = text[i];
 		const unsigned int byteCount = UTF8BytesOfLead[uch];
 		const int codeUnits = UTF16LengthFromUTF8ByteCount(byteCount);
-		qreal xPosition = tl.cursorToX(ui+codeUnits);
+		qreal xPosition = tl.cursorToX(uiStart+ui+codeUnits) - xStart;
 		for (size_t bytePos=0; (bytePos<byteCount) && (i<text.length()); bytePos++) {
 			positions[i++] = xPosition;
 		}
@@ -717,9 +784,108 @@ void SurfaceImpl::MeasureWidthsUTF8(const Font *font,
 	}
 }
 
+// Text that would add extra lines to a batch layout.
+bool BreaksBatchLayout(const QString &su)
+{
+	if (su.isEmpty())
+		return true;
+	for (const QChar ch : su) {
+		if (ch == QLatin1Char('\n') || ch == QLatin1Char('\r') ||
+			ch == QChar(QChar::LineSeparator) || ch == QChar(QChar::ParagraphSeparator))
+			return true;
+	}
+	return false;
+}
+
+}
+
+void SurfaceImpl::MeasureWidthsUTF8(const Font *font,
+				Sci::string_view text,
+				XYPOSITION *positions)
+{
+	if (!font)
+		return;
+	MeasuringLayout &ml = AsFontAndCharacterSet(font)->Measuring(GetPaintDevice());
+	const QTextLine &tl = ml.Line(nullptr, text);
+	PositionsFromLineUTF8(tl, 0, 0.0, text, ml.TextLength(), positions);
+}
+
+void SurfaceImpl::MeasureWidthsBatchUTF8(const TextMeasureRequest *requests, size_t count)
+{
+	if (count == 0)
+		return;
+
+	// Lay out all the requests in one QTextLayout with a format range for each request's
+	// font and a forced line break between requests so they are shaped independently.
+	bool batchable = count > 1;
+	QString su;
+	std::vector<int> starts;
+	std::vector<int> lengths;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+	QVector<QTextLayout::FormatRange> formats;
+#else
+	QList<QTextLayout::FormatRange> formats;
+#endif
+	for (size_t k = 0; (k < count) && batchable; k++) {
+		if (!requests[k].font) {
+			batchable = false;
+			break;
+		}
+		const QString segment = QString::fromUtf8(requests[k].text.data(),
+			static_cast<int>(requests[k].text.length()));
+		if (BreaksBatchLayout(segment)) {
+			batchable = false;
+			break;
+		}
+		QTextLayout::FormatRange range;
+		range.start = su.size();
+		range.length = segment.size();
+		range.format.setFont(*FontPointer(requests[k].font));
+		formats.append(range);
+		starts.push_back(su.size());
+		lengths.push_back(segment.size());
+		su += segment;
+		if (k + 1 < count)
+			su += QChar(QChar::LineSeparator);
+	}
+
+	if (batchable) {
+		QTextLayout tlay(su, *FontPointer(requests[0].font), GetPaintDevice());
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+		tlay.setFormats(formats);
+#else
+		tlay.setAdditionalFormats(formats);
+#endif
+		tlay.beginLayout();
+		for (size_t k = 0; k < count; k++) {
+			QTextLine tl = tlay.createLine();
+			if (!tl.isValid())
+				break;
+		}
+		tlay.endLayout();
+		batchable = tlay.lineCount() == static_cast<int>(count);
+		for (size_t k = 0; (k < count) && batchable; k++) {
+			if (tlay.lineAt(static_cast<int>(k)).textStart() != starts[k])
+				batchable = false;
+		}
+		if (batchable) {
+			for (size_t k = 0; k < count; k++) {
+				const QTextLine tl = tlay.lineAt(static_cast<int>(k));
+				PositionsFromLineUTF8(tl, starts[k], tl.cursorToX(starts[k]),
+					requests[k].text, lengths[k], requests[k].positions);
+			}
+			return;
+		}
+	}
+
+	for (size_t k = 0; k < count; k++) {
+		MeasureWidthsUTF8(requests[k].font, requests[k].text, requests[k].positions);
+	}
+}
+
 XYPOSITION SurfaceImpl::WidthTextUTF8(const Font *font, Sci::string_view text)
 {
-	QFontMetricsF metrics(*FontPointer(font), device);
+	const QFontMetricsF metrics = AsFontAndCharacterSet(font)->Metrics(device);
 	QString su = QString::fromUtf8(text.data(), static_cast<int>(text.length()));
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 	return metrics.horizontalAdvance(su);
@@ -730,13 +896,13 @@ XYPOSITION SurfaceImpl::WidthTextUTF8(const Font *font, Sci::string_view text)
 
 XYPOSITION SurfaceImpl::Ascent(const Font *font)
 {
-	QFontMetricsF metrics(*FontPointer(font), device);
+	const QFontMetricsF metrics = AsFontAndCharacterSet(font)->Metrics(device);
 	return metrics.ascent();
 }
 
 XYPOSITION SurfaceImpl::Descent(const Font *font)
 {
-	QFontMetricsF metrics(*FontPointer(font), device);
+	const QFontMetricsF metrics = AsFontAndCharacterSet(font)->Metrics(device);
 	// Qt returns 1 less than true descent
 	// See: QFontEngineWin::descent which says:
 	// ### we subtract 1 to even out the historical +1 in QFontMetrics's
@@ -751,13 +917,13 @@ XYPOSITION SurfaceImpl::InternalLeading(const Font * /* font */)
 
 XYPOSITION SurfaceImpl::Height(const Font *font)
 {
-	QFontMetricsF metrics(*FontPointer(font), device);
+	const QFontMetricsF metrics = AsFontAndCharacterSet(font)->Metrics(device);
 	return metrics.height();
 }
 
 XYPOSITION SurfaceImpl::AverageCharWidth(const Font *font)
 {
-	QFontMetricsF metrics(*FontPointer(font), device);
+	const QFontMetricsF metrics = AsFontAndCharacterSet(font)->Metrics(device);
 	return metrics.averageCharWidth();
 }
 
@@ -136,6 +136,7 @@ public:
 	void MeasureWidthsUTF8(const Font *font_, Sci::string_view text,
 		XYPOSITION *positions) override;
 	XYPOSITION WidthTextUTF8(const Font *font_, Sci::string_view text) override;
+	void MeasureWidthsBatchUTF8(const TextMeasureRequest *requests, size_t count) override;
 
 	XYPOSITION Ascent(const Font *font) override;
 	XYPOSITION Descent(const Font *font) override;
@@ -8,6 +8,7 @@
 // Copyright 2013 by Neil Hodgson <neilh@scintilla.org>
 // The License.txt file describes the conditions under which this software may be distributed.
 
+#include <cstdint>
 #include <cassert>
 #include <cstring>
 
@@ -580,12 +581,35 @@ SCI_CONSTEXPR14 const Sci::string_view complexCaseConversions =
 // Maximum length of a case conversion result is 6 bytes in UTF-8
 constexpr size_t maxConversionLength = 6;
 
+constexpr int maxUnicode = 0x10ffff;
+
+// Characters are looked up in pages of 256
+constexpr int pageShift = 8;
+constexpr int pageSize = 1 << pageShift;
+constexpr int pages = (maxUnicode + 1) >> pageShift;
+
+// Find the end of a run of ASCII starting at position, checking 8 bytes at a time.
+size_t AsciiRunEnd(const char *s, size_t position, size_t length) noexcept {
+	constexpr uint64_t highBits = 0x8080808080808080U;
+	while (position + sizeof(uint64_t) <= length) {
+		uint64_t block = 0;
+		memcpy(&block, s + position, sizeof(block));
+		if (block & highBits)
+			break;
+		position += sizeof(uint64_t);
+	}
+	while ((position < length) && UTF8IsAscii(s[position])) {
+		position++;
+	}
+	return position;
+}
+
 class CaseConverter final : public ICaseConverter {
 	struct ConversionString {
 		char conversion[maxConversionLength+1]{};
 	};
-	// Conversions are initially store in a vector of structs but then decomposed into
-	// parallel arrays as that is about 10% faster to search.
+	// Conversions are initially store in a vector of structs but then moved into an
+	// array of conversions indexed by a two stage table so finding is a direct lookup.
 	struct CharacterConversion {
 		int character = 0;
 		ConversionString conversion;
@@ -607,26 +631,29 @@ class CaseConverter final : public ICaseConverter {
 	};
 	typedef std::vector<CharacterConversion> CharacterToConversion;
 	CharacterToConversion characterToConversion;
-	// The parallel arrays
-	std::vector<int> characters;
+	// Stage one maps each page of 256 characters to a block in stage two which holds
+	// 1 + the index of the conversion or 0 for none. Pages without conversions share block 0.
+	std::vector<uint16_t> stageOne;
+	std::vector<uint16_t> stageTwo;
 	std::vector<ConversionString> conversions;
+	// ASCII converts to single ASCII bytes so runs of ASCII can avoid searching
+	unsigned char asciiConversions[0x80]{};
+	bool asciiSimple = false;
 
 public:
 	CaseConverter() noexcept = default;
 	bool Initialised() const noexcept {
-		return !characters.empty();
+		return !conversions.empty();
 	}
 	void Add(int character, Sci::string_view conversion_) {
 		characterToConversion.emplace_back(character, conversion_);
 	}
-	const char *Find(int character) {
-		const std::vector<int>::iterator it = std::lower_bound(characters.begin(), characters.end(), character);
-		if (it == characters.end())
-			return nullptr;
-		else if (*it == character)
-			return conversions[it - characters.begin()].conversion;
-		else
+	const char *Find(int character) const noexcept {
+		if ((character < 0) || (character > maxUnicode))
 			return nullptr;
+		const unsigned block = stageOne[character >> pageShift];
+		const unsigned index = stageTwo[block * pageSize + (character & (pageSize - 1))];
+		return index ? conversions[index - 1].conversion : nullptr;
 	}
 	size_t CaseConvertString(char *converted, size_t sizeConverted, const char *mixed, size_t lenMixed) override {
 		size_t lenConverted = 0;
@@ -634,6 +661,15 @@ public:
 		unsigned char bytes[UTF8MaxBytes + 1]{};
 		while (mixedPos < lenMixed) {
 			const unsigned char leadByte = mixed[mixedPos];
+			if (asciiSimple && UTF8IsAscii(leadByte)) {
+				const size_t endRun = AsciiRunEnd(mixed, mixedPos + 1, lenMixed);
+				if (lenConverted + endRun - mixedPos > sizeConverted)
+					return 0;
+				for (; mixedPos < endRun; mixedPos++) {
+					converted[lenConverted++] = asciiConversions[static_cast<unsigned char>(mixed[mixedPos])];
+				}
+				continue;
+			}
 			const char *caseConverted = nullptr;
 			size_t lenMixedChar = 1;
 			if (UTF8IsAscii(leadByte)) {
@@ -655,16 +691,16 @@ public:
 			if (caseConverted) {
 				// Character has a conversion so copy that conversion in
 				while (*caseConverted) {
-					converted[lenConverted++] = *caseConverted++;
 					if (lenConverted >= sizeConverted)
 						return 0;
+					converted[lenConverted++] = *caseConverted++;
 				}
 			} else {
 				// Character has no conversion so copy the input to output
 				for (size_t i=0; i<lenMixedChar; i++) {
-					converted[lenConverted++] = mixed[mixedPos+i];
 					if (lenConverted >= sizeConverted)
 						return 0;
+					converted[lenConverted++] = mixed[mixedPos+i];
 				}
 			}
 			mixedPos += lenMixedChar;
@@ -673,27 +709,46 @@ public:
 	}
 	void FinishedAdding() {
 		std::sort(characterToConversion.begin(), characterToConversion.end());
-		characters.reserve(characterToConversion.size());
+		assert(characterToConversion.size() < UINT16_MAX);
+		stageOne.assign(pages, 0);
+		stageTwo.assign(pageSize, 0);
 		conversions.reserve(characterToConversion.size());
 		for (const CharacterConversion &chConv : characterToConversion) {
-			characters.push_back(chConv.character);
+			const int page = chConv.character >> pageShift;
+			if (stageOne[page] == 0) {
+				stageOne[page] = static_cast<uint16_t>(stageTwo.size() / pageSize);
+				stageTwo.resize(stageTwo.size() + pageSize);
+			}
 			conversions.push_back(chConv.conversion);
+			stageTwo[stageOne[page] * pageSize + (chConv.character & (pageSize - 1))] =
+				static_cast<uint16_t>(conversions.size());
 		}
 		// Empty the original calculated data completely
 		CharacterToConversion().swap(characterToConversion);
+		asciiSimple = true;
+		for (int ch = 0; ch < 0x80; ch++) {
+			const char *caseConverted = Find(ch);
+			if (!caseConverted) {
+				asciiConversions[ch] = static_cast<unsigned char>(ch);
+			} else if (UTF8IsAscii(caseConverted[0]) && caseConverted[0] && !caseConverted[1]) {
+				asciiConversions[ch] = caseConverted[0];
+			} else {
+				asciiSimple = false;
+			}
+		}
 	}
-	void AddSymmetric(CaseConversion conversion, int lower, int upper);
 	void SetupConversions(CaseConversion conversion);
 };
 
 CaseConverter caseConvList[3];
 
-void CaseConverter::AddSymmetric(CaseConversion conversion, int lower, int upper) {
+template <typename AddConversion>
+void AddSymmetric(CaseConversion conversion, int lower, int upper, AddConversion add) {
 	const int character = (conversion == CaseConversion::upper) ? lower : upper;
 	const int source = (conversion == CaseConversion::upper) ? upper : lower;
 	char converted[maxConversionLength+1]{};
 	UTF8FromUTF32Character(source, converted);
-	Add(character, converted);
+	add(character, converted);
 }
 
 // Return the next '|' separated field and remove from view.
@@ -710,7 +765,9 @@ Sci::string_view NextField(Sci::string_view &view) {
 	return field;
 }
 
-void CaseConverter::SetupConversions(CaseConversion conversion) {
+// Call add for each character with a conversion, in the order of the generated data.
+template <typename AddConversion>
+void ForEachConversion(CaseConversion conversion, AddConversion add) {
 	// First initialize for the symmetric ranges
 	for (size_t i=0; i<Sci::size(symmetricCaseConversionRanges);) {
 		const int lower = symmetricCaseConversionRanges[i++];
@@ -718,14 +775,14 @@ void CaseConverter::SetupConversions(CaseConversion conversion) {
 		const int length = symmetricCaseConversionRanges[i++];
 		const int pitch = symmetricCaseConversionRanges[i++];
 		for (int j=0; j<length*pitch; j+=pitch) {
-			AddSymmetric(conversion, lower+j, upper+j);
+			AddSymmetric(conversion, lower+j, upper+j, add);
 		}
 	}
 	// Add the symmetric singletons
 	for (size_t i=0; i<Sci::size(symmetricCaseConversions);) {
 		const int lower = symmetricCaseConversions[i++];
 		const int upper = symmetricCaseConversions[i++];
-		AddSymmetric(conversion, lower, upper);
+		AddSymmetric(conversion, lower, upper, add);
 	}
 	// Add the complex cases
 	Sci::string_view sComplex = complexCaseConversions;
@@ -750,10 +807,15 @@ void CaseConverter::SetupConversions(CaseConversion conversion) {
 		}
 		if (!converted.empty()) {
 			const int character = UnicodeFromUTF8(reinterpret_cast<const unsigned char *>(originUTF8.data()));
-			Add(character, converted);
+			add(character, converted);
 		}
 	}
+}
 
+void CaseConverter::SetupConversions(CaseConversion conversion) {
+	ForEachConversion(conversion, [this](int character, Sci::string_view converted) {
+		Add(character, converted);
+	});
 	FinishedAdding();
 }
 
@@ -785,6 +847,19 @@ size_t CaseConvertString(char *converted, size_t sizeConverted, const char *mixe
 	return pCaseConv->CaseConvertString(converted, sizeConverted, mixed, lenMixed);
 }
 
+// The conversions from the generated data sorted by character, independent of the lookup tables
+// so that lookups can be checked. Not part of the interface so only declared by the unit tests.
+std::vector<std::pair<int, std::string>> CaseConversionsSorted(CaseConversion conversion);
+
+std::vector<std::pair<int, std::string>> CaseConversionsSorted(CaseConversion conversion) {
+	std::vector<std::pair<int, std::string>> characterConversions;
+	ForEachConversion(conversion, [&characterConversions](int character, Sci::string_view converted) {
+		characterConversions.emplace_back(character, std::string(converted.data(), converted.length()));
+	});
+	std::sort(characterConversions.begin(), characterConversions.end());
+	return characterConversions;
+}
+
 std::string CaseConvertString(const std::string &s, CaseConversion conversion) {
 	std::string retMapped(s.length() * maxExpansionCaseConversion, 0);
 	const size_t lenMapped = CaseConvertString(&retMapped[0], retMapped.length(), s.c_str(), s.length(),
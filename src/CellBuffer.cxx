@@ -494,6 +494,136 @@ const char *CellBuffer::DeleteChars(Sci::Position position, Sci::Position delete
 	return data;
 }
 
+namespace {
+
+// Call visit with the offset after each line end in text.
+template <typename Visit>
+void VisitLineStarts(Sci::string_view text, bool unicodeLineEnds, Visit visit) {
+	for (size_t i = 0; i < text.length(); i++) {
+		const unsigned char ch = text[i];
+		if (ch == '\r') {
+			if ((i + 1 < text.length()) && (text[i + 1] == '\n')) {
+				i++;
+			}
+			visit(i + 1);
+		} else if (ch == '\n') {
+			visit(i + 1);
+		} else if (unicodeLineEnds && (i >= 1) && UTF8IsTrailByte(ch)) {
+			const unsigned char chBeforePrev = (i >= 2) ? text[i - 2] : 0;
+			if (UTF8IsMultibyteLineEnd(chBeforePrev, text[i - 1], ch)) {
+				visit(i + 1);
+			}
+		}
+	}
+}
+
+size_t NextLineStart(Sci::string_view text, size_t start) noexcept {
+	for (size_t i = start; i < text.length(); i++) {
+		if (text[i] == '\n') {
+			return i + 1;
+		}
+		if (text[i] == '\r') {
+			return ((i + 1 < text.length()) && (text[i + 1] == '\n')) ? i + 2 : i + 1;
+		}
+	}
+	return text.length();
+}
+
+// Pair the lines of removed and inserted in order and trim what each pair has in common
+// at both ends so that unchanged text keeps its change history and decorations.
+std::vector<LineChange> LineChanges(Sci::Position position, Sci::string_view removed, Sci::string_view inserted) {
+	std::vector<LineChange> changes;
+	size_t startRemoved = 0;
+	size_t startInserted = 0;
+	while ((startRemoved < removed.length()) || (startInserted < inserted.length())) {
+		const size_t endRemoved = NextLineStart(removed, startRemoved);
+		const size_t endInserted = NextLineStart(inserted, startInserted);
+		Sci::string_view lineRemoved = removed.substr(startRemoved, endRemoved - startRemoved);
+		Sci::string_view lineInserted = inserted.substr(startInserted, endInserted - startInserted);
+		size_t prefix = 0;
+		while ((prefix < lineRemoved.length()) && (prefix < lineInserted.length()) &&
+			(lineRemoved[prefix] == lineInserted[prefix])) {
+			prefix++;
+		}
+		lineRemoved.remove_prefix(prefix);
+		lineInserted.remove_prefix(prefix);
+		while (!lineRemoved.empty() && !lineInserted.empty() && (lineRemoved.back() == lineInserted.back())) {
+			lineRemoved.remove_suffix(1);
+			lineInserted.remove_suffix(1);
+		}
+		if (!lineRemoved.empty() || !lineInserted.empty()) {
+			changes.emplace_back(position + startRemoved + prefix, lineRemoved.length(), lineInserted.length());
+		}
+		startRemoved = endRemoved;
+		startInserted = endInserted;
+	}
+	return changes;
+}
+
+}
+
+bool CellBuffer::ReplaceKeepsLines(Sci::Position position, Sci::string_view removed, Sci::string_view inserted) const noexcept {
+	const Sci::Position end = position + removed.length();
+	if (removed.empty() || inserted.empty() || (position < 0) || (end > Length())) {
+		return false;
+	}
+	const unsigned char chBefore = substance.ValueAt(position - 1);
+	const unsigned char chAfter = substance.ValueAt(end);
+	// A CR LF pair or UTF-8 line end across either end would join or split lines
+	if ((chBefore == '\r') && ((removed.front() == '\n') || (inserted.front() == '\n'))) {
+		return false;
+	}
+	if ((chAfter == '\n') && ((removed.back() == '\r') || (inserted.back() == '\r'))) {
+		return false;
+	}
+	const bool unicodeLineEnds = utf8LineEnds == LineEndType::Unicode;
+	if (unicodeLineEnds && (UTF8IsTrailByte(removed.front()) || UTF8IsTrailByte(inserted.front()) ||
+		UTF8IsTrailByte(chAfter))) {
+		return false;
+	}
+	size_t linesRemoved = 0;
+	VisitLineStarts(removed, unicodeLineEnds, [&linesRemoved](size_t) noexcept {
+		linesRemoved++;
+	});
+	size_t linesInserted = 0;
+	VisitLineStarts(inserted, unicodeLineEnds, [&linesInserted](size_t) noexcept {
+		linesInserted++;
+	});
+	return linesRemoved == linesInserted;
+}
+
+void CellBuffer::ReplaceKeepingLines(Sci::Position position, Sci::string_view removed, Sci::string_view inserted,
+	std::vector<LineChange> &changes, bool &startSequence) {
+	PLATFORM_ASSERT(ReplaceKeepsLines(position, removed, inserted));
+	if (!readOnly) {
+		changes = LineChanges(position, removed, inserted);
+		if (collectingUndo) {
+			// Grouped so that the replacing insertion always joins the removal
+			uh->BeginUndoAction();
+			uh->AppendAction(ActionType::remove, position, removed.data(), removed.length(), startSequence);
+			bool startInsertion = false;
+			uh->AppendAction(ActionType::insert, position, inserted.data(), inserted.length(), startInsertion, true, true);
+			uh->EndUndoAction();
+		}
+
+		if (changeHistory) {
+			const bool beforeSave = uh->BeforeReachableSavePoint();
+			const bool detached = uh->AfterOrAtDetachPoint();
+			// From the end so that earlier positions are unaffected
+			for (auto it = changes.rbegin(); it != changes.rend(); ++it) {
+				if (it->lengthRemoved) {
+					changeHistory->DeleteRangeSavingHistory(it->position, it->lengthRemoved, beforeSave, detached);
+				}
+				if (it->lengthInserted) {
+					changeHistory->Insert(it->position, it->lengthInserted, collectingUndo, beforeSave);
+				}
+			}
+		}
+
+		BasicReplaceKeepingLines(position, removed.length(), inserted.data(), inserted.length());
+	}
+}
+
 Sci::Position CellBuffer::Length() const noexcept {
 	return substance.Length();
 }
@@ -1055,6 +1185,27 @@ void CellBuffer::BasicDeleteChars(Sci::Position position, Sci::Position deleteLe
 	}
 }
 
+void CellBuffer::BasicReplaceKeepingLines(Sci::Position position, Sci::Position deleteLength, const char *s, Sci::Position insertLength) {
+	const Sci::Line lineFirst = plv->LineFromPosition(position);
+	substance.DeleteRange(position, deleteLength);
+	substance.InsertFromArray(position, s, 0, insertLength);
+	if (hasStyles) {
+		style.DeleteRange(position, deleteLength);
+		style.InsertValue(position, insertLength, 0);
+	}
+	// Move the lines after the replacement then set the starts of the lines inside it
+	plv->InsertText(lineFirst, insertLength - deleteLength);
+	Sci::Line line = lineFirst;
+	VisitLineStarts(Sci::string_view(s, insertLength), utf8LineEnds == LineEndType::Unicode,
+		[this, position, &line](size_t offset) noexcept {
+		line++;
+		plv->SetLineStart(line, position + offset);
+	});
+	if (MaintainingLineCharacterIndex()) {
+		RecalculateIndexLineStarts(lineFirst, line);
+	}
+}
+
 bool CellBuffer::SetUndoCollection(bool collectUndo) noexcept {
 	collectingUndo = collectUndo;
 	uh->DropUndoSequence();
@@ -1157,6 +1308,84 @@ void CellBuffer::PerformRedoStep() {
 	uh->CompletedRedoStep();
 }
 
+bool CellBuffer::UndoStepIsReplacement() const noexcept {
+	return uh->UndoStepIsReplacement();
+}
+
+Action CellBuffer::GetUndoReplacedStep() const noexcept {
+	return uh->GetUndoReplacedStep();
+}
+
+void CellBuffer::PerformUndoReplacement(std::vector<LineChange> &changes) {
+	const Action insertion = uh->GetUndoStep();
+	const Action removal = uh->GetUndoReplacedStep();
+	if (substance.Length() < insertion.position + insertion.lenData) {
+		throw std::runtime_error(
+			"CellBuffer::PerformUndoReplacement: replacement must be inside document.");
+	}
+	changes = LineChanges(removal.position, Sci::string_view(removal.data, removal.lenData),
+		Sci::string_view(insertion.data, insertion.lenData));
+	// Change history flags as for PerformUndoStep of the insertion then the removal
+	if (changeHistory && uh->PreviousBeforeSavePoint()) {
+		changeHistory->StartReversion();
+	}
+	const bool revertingInsertion = uh->PreviousBeforeSavePoint() && !uh->AfterDetachPoint();
+	uh->CompletedUndoStep();
+	if (changeHistory && uh->PreviousBeforeSavePoint()) {
+		changeHistory->StartReversion();
+	}
+	const bool detachedRemoval = uh->AfterDetachPoint();
+	uh->CompletedUndoStep();
+	if (changeHistory) {
+		// Forwards since undoing each line restores the positions after it
+		for (const LineChange &change : changes) {
+			if (change.lengthInserted) {
+				changeHistory->DeleteRange(change.position, change.lengthInserted, revertingInsertion);
+			}
+			if (change.lengthRemoved) {
+				changeHistory->UndoDeleteStep(change.position, change.lengthRemoved, detachedRemoval);
+			}
+		}
+	}
+	BasicReplaceKeepingLines(insertion.position, insertion.lenData, removal.data, removal.lenData);
+}
+
+bool CellBuffer::RedoStepIsReplacement() const noexcept {
+	return uh->RedoStepIsReplacement();
+}
+
+Action CellBuffer::GetRedoReplacingStep() const noexcept {
+	return uh->GetRedoReplacingStep();
+}
+
+void CellBuffer::PerformRedoReplacement(std::vector<LineChange> &changes) {
+	const Action removal = uh->GetRedoStep();
+	const Action insertion = uh->GetRedoReplacingStep();
+	changes = LineChanges(removal.position, Sci::string_view(removal.data, removal.lenData),
+		Sci::string_view(insertion.data, insertion.lenData));
+	// Change history flags as for PerformRedoStep of the removal then the insertion
+	const bool beforeSaveRemoval = uh->BeforeReachableSavePoint();
+	const bool detachedRemoval = uh->AfterOrAtDetachPoint();
+	uh->CompletedRedoStep();
+	const bool beforeSaveInsertion = uh->BeforeSavePoint() && !uh->AfterOrAtDetachPoint();
+	const bool afterSave = uh->AfterSavePoint();
+	uh->CompletedRedoStep();
+	if (changeHistory) {
+		for (auto it = changes.rbegin(); it != changes.rend(); ++it) {
+			if (it->lengthRemoved) {
+				changeHistory->DeleteRangeSavingHistory(it->position, it->lengthRemoved, beforeSaveRemoval, detachedRemoval);
+			}
+			if (it->lengthInserted) {
+				changeHistory->Insert(it->position, it->lengthInserted, collectingUndo, beforeSaveInsertion);
+			}
+		}
+		if (afterSave) {
+			changeHistory->EndReversion();
+		}
+	}
+	BasicReplaceKeepingLines(removal.position, removal.lenData, insertion.data, insertion.lenData);
+}
+
 int CellBuffer::UndoActions() const noexcept {
 	return uh->Actions();
 }
@@ -1193,7 +1422,7 @@ void RestoreChangeHistory(const UndoHistory *uh, ChangeHistory *changeHistory) {
 	const int detachPoint = uh->DetachPoint();
 	const int currentPoint = uh->Current();
 	for (int act = 0; act < uh->Actions(); act++) {
-		const ActionType type = static_cast<ActionType>(uh->Type(act) & ~coalesceFlag);
+		const ActionType type = static_cast<ActionType>(uh->Type(act) & ~(coalesceFlag | replaceFlag));
 		const Sci::Position position = uh->Position(act);
 		const Sci::Position length = uh->Length(act);
 		const bool beforeSave = act < savePoint || ((detachPoint >= 0) && (detachPoint > act));
@@ -1213,7 +1442,7 @@ void RestoreChangeHistory(const UndoHistory *uh, ChangeHistory *changeHistory) {
 	}
 	// Undo back to currentPoint, updating change history
 	for (int act = uh->Actions() - 1; act >= currentPoint; act--) {
-		const ActionType type = static_cast<ActionType>(uh->Type(act) & ~coalesceFlag);
+		const ActionType type = static_cast<ActionType>(uh->Type(act) & ~(coalesceFlag | replaceFlag));
 		const Sci::Position position = uh->Position(act);
 		const Sci::Position length = uh->Length(act);
 		const bool beforeSave = act < savePoint;
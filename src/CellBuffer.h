@@ -43,6 +43,17 @@ struct Action {
 	Action(ActionType at = ActionType::insert, bool mayCoalesce = false, Sci::Position position = 0, const char* data = nullptr, Sci::Position lenData = 0) : at(at), mayCoalesce(mayCoalesce), position(position), data(data), lenData(lenData) { }
 };
 
+/**
+ * The changed part of one line of a replacement that keeps lines, in positions before the change.
+ */
+struct LineChange {
+	Sci::Position position = 0;
+	Sci::Position lengthRemoved = 0;
+	Sci::Position lengthInserted = 0;
+
+	LineChange(Sci::Position position = 0, Sci::Position lengthRemoved = 0, Sci::Position lengthInserted = 0) : position(position), lengthRemoved(lengthRemoved), lengthInserted(lengthInserted) { }
+};
+
 struct SplitView {
 	const char *segment1 = nullptr;
 	size_t length1 = 0;
@@ -101,6 +112,7 @@ private:
 	/// Actions without undo
 	void BasicInsertString(Sci::Position position, const char *s, Sci::Position insertLength);
 	void BasicDeleteChars(Sci::Position position, Sci::Position deleteLength);
+	void BasicReplaceKeepingLines(Sci::Position position, Sci::Position deleteLength, const char *s, Sci::Position insertLength);
 
 public:
 
@@ -151,6 +163,14 @@ public:
 
 	const char *DeleteChars(Sci::Position position, Sci::Position deleteLength, bool &startSequence);
 
+	/// A replacement keeps lines when removed and inserted are not empty, have the same line ends
+	/// and do not join or split a line end with the text around them.
+	/// Such a replacement updates line starts in place so per-line data is kept and is undone and
+	/// redone as one step. changes receives the changed part of each line.
+	bool ReplaceKeepsLines(Sci::Position position, Sci::string_view removed, Sci::string_view inserted) const noexcept;
+	void ReplaceKeepingLines(Sci::Position position, Sci::string_view removed, Sci::string_view inserted,
+		std::vector<LineChange> &changes, bool &startSequence);
+
 	bool IsReadOnly() const noexcept;
 	void SetReadOnly(bool set) noexcept;
 	bool IsLarge() const noexcept;
@@ -184,6 +204,12 @@ public:
 	int StartRedo() noexcept;
 	Action GetRedoStep() const noexcept;
 	void PerformRedoStep();
+	bool UndoStepIsReplacement() const noexcept;
+	Action GetUndoReplacedStep() const noexcept;
+	void PerformUndoReplacement(std::vector<LineChange> &changes);
+	bool RedoStepIsReplacement() const noexcept;
+	Action GetRedoReplacingStep() const noexcept;
+	void PerformRedoReplacement(std::vector<LineChange> &changes);
 
 	int UndoActions() const noexcept;
 	void SetUndoSavePoint(int action) noexcept;
@@ -4040,27 +4040,81 @@ constexpr int maskCategory = 0x1F;
 
 }
 
+CharacterCategory SearchCategory(int character) noexcept {
+	const int baseValue = character * (maskCategory+1) + maskCategory;
+	try {
+		// lower_bound will never throw with these args but its not marked noexcept so add catch to pretend.
+		const int *placeAfter = std::lower_bound(catRanges, std::end(catRanges), baseValue);
+		return static_cast<CharacterCategory>(*(placeAfter - 1) & maskCategory);
+	} catch (...) {
+		return ccCn;
+	}
+}
+
+namespace {
+
+// Two stage table expanded from catRanges covering all of Unicode.
+// Identical pages of categoryPageSize characters are shared so the table is around 48K.
+class CategoryTable {
+public:
+	std::vector<unsigned short> pageBlocks;
+	std::vector<unsigned char> categories;
+	CategoryTable() {
+		constexpr int pages = (maxUnicode + 1) / categoryPageSize;
+		pageBlocks.resize(pages);
+		std::vector<unsigned char> page(categoryPageSize);
+		size_t range = 0;
+		for (int pageNumber = 0; pageNumber < pages; pageNumber++) {
+			const int pageStart = pageNumber * categoryPageSize;
+			for (int i = 0; i < categoryPageSize; i++) {
+				const int character = pageStart + i;
+				while ((range + 1 < Sci::size(catRanges)) && ((catRanges[range + 1] >> 5) <= character)) {
+					range++;
+				}
+				page[i] = catRanges[range] & maskCategory;
+			}
+			// Runs of identical pages are common so try the previous page's block first
+			size_t block = pageNumber ? pageBlocks[pageNumber - 1] * categoryPageSize : 0;
+			if ((block >= categories.size()) || !std::equal(page.begin(), page.end(), categories.begin() + block)) {
+				block = 0;
+			}
+			while ((block < categories.size()) &&
+				!std::equal(page.begin(), page.end(), categories.begin() + block)) {
+				block += categoryPageSize;
+			}
+			if (block == categories.size()) {
+				categories.insert(categories.end(), page.begin(), page.end());
+			}
+			pageBlocks[pageNumber] = static_cast<unsigned short>(block / categoryPageSize);
+		}
+	}
+};
+
+const CategoryTable &SharedCategoryTable() {
+	static const CategoryTable table;
+	return table;
+}
+
+}
+
 // Each element in catRanges is the start of a range of Unicode characters in
 // one general category.
 // The value is comprised of a 21-bit character value shifted 5 bits and a 5 bit
 // category matching the CharacterCategory enumeration.
 // Initial version has 3249 entries and adds about 13K to the executable.
 // The array is in ascending order so can be searched using binary search.
-// Therefore the average call takes log2(3249) = 12 comparisons.
-// For speed, it may be useful to make a linear table for the common values,
-// possibly for 0..0xff for most Western European text or 0..0xfff for most
-// alphabetic languages.
+// For speed, it is expanded once into a two stage table giving a direct lookup.
+// Binary search is only used if the table can not be allocated.
 
 CharacterCategory CategoriseCharacter(int character) noexcept {
 	if (character < 0 || character > maxUnicode)
 		return ccCn;
-	const int baseValue = character * (maskCategory+1) + maskCategory;
 	try {
-		// lower_bound will never throw with these args but its not marked noexcept so add catch to pretend.
-		const int *placeAfter = std::lower_bound(catRanges, std::end(catRanges), baseValue);
-		return static_cast<CharacterCategory>(*(placeAfter - 1) & maskCategory);
+		const CategoryTable &table = SharedCategoryTable();
+		return static_cast<CharacterCategory>(table.categories[
+			table.pageBlocks[character / categoryPageSize] * categoryPageSize + character % categoryPageSize]);
 	} catch (...) {
-		return ccCn;
+		return SearchCategory(character);
 	}
 }
 
@@ -4211,6 +4265,9 @@ bool IsXidContinue(int character) noexcept {
 }
 
 CharacterCategoryMap::CharacterCategoryMap() {
+	const CategoryTable &table = SharedCategoryTable();
+	pageBlocks = table.pageBlocks.data();
+	categories = table.categories.data();
 	Optimize(256);
 }
 
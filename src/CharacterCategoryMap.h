@@ -23,6 +23,8 @@ enum CharacterCategory {
 };
 
 CharacterCategory CategoriseCharacter(int character) noexcept;
+// Binary search of the compressed ranges, used when the two stage table can not be allocated.
+CharacterCategory SearchCategory(int character) noexcept;
 
 // Common definitions of allowable characters in identifiers from UAX #31.
 bool IsIdStart(int character) noexcept;
@@ -30,17 +32,26 @@ bool IsIdContinue(int character) noexcept;
 bool IsXidStart(int character) noexcept;
 bool IsXidContinue(int character) noexcept;
 
+// Characters are categorised in pages that index into shared blocks.
+constexpr int categoryPageSize = 0x100;
+constexpr int categoryCharacters = 0x110000;
+
 class CharacterCategoryMap {
 private:
 	std::vector<unsigned char> dense;
+	// Two stage table shared between all maps
+	const unsigned short *pageBlocks = nullptr;
+	const unsigned char *categories = nullptr;
 public:
 	CharacterCategoryMap();
 	CharacterCategory CategoryFor(int character) const noexcept {
 		if (static_cast<size_t>(character) < dense.size()) {
 			return static_cast<CharacterCategory>(dense[character]);
+		} else if (static_cast<unsigned int>(character) < categoryCharacters) {
+			return static_cast<CharacterCategory>(categories[
+				pageBlocks[character / categoryPageSize] * categoryPageSize + character % categoryPageSize]);
 		} else {
-			// binary search through ranges
-			return CategoriseCharacter(character);
+			return ccCn;
 		}
 	}
 	int Size() const noexcept;
@@ -84,13 +84,20 @@ class DecorationList : public IDecorationList {
 	// Ordered by indicator
 	std::vector<std::unique_ptr<Decoration<POS>>> decorationList;
 	std::vector<const IDecoration*> decorationView;	// Read-only view of decorationList
+	// Bit mask of the indicators below IndicatorNumbers::Ime with non-zero values at each position,
+	// maintained alongside the decorations so AllOnFor is a single lookup.
+	RunStyles<POS, int> allOn;
 	bool clickNotified;
+	unsigned int version;
 
 	Decoration<POS> *DecorationFromIndicator(int indicator) noexcept;
 	Decoration<POS> *Create(int indicator, Sci::Position length);
 	void Delete(int indicator);
 	void DeleteAnyEmpty();
 	void SetView();
+	int MaskAt(Sci::Position position) const noexcept;
+	void SetAllOnBit(int indicator, int value, Sci::Position position, Sci::Position fillLength);
+	void RebuildAllOn();
 
 	// pos_cast(): cast Sci::Position to either 32-bit or 64-bit value
 	// This avoids warnings from Visual C++ Code Analysis and shortens code
@@ -121,6 +128,7 @@ public:
 	void DeleteLexerDecorations() override;
 
 	int AllOnFor(Sci::Position position) const noexcept override;
+	Sci::Position AllOnEnd(Sci::Position position) const noexcept override;
 	int ValueAt(int indicator, Sci::Position position) noexcept override;
 	Sci::Position Start(int indicator, Sci::Position position) noexcept override;
 	Sci::Position End(int indicator, Sci::Position position) noexcept override;
@@ -131,11 +139,15 @@ public:
 	void SetClickNotified(bool notified) noexcept override {
 		clickNotified = notified;
 	}
+
+	unsigned int Version() const noexcept override {
+		return version;
+	}
 };
 
 template <typename POS>
 DecorationList<POS>::DecorationList() : currentIndicator(0), currentValue(1), current(nullptr),
-	lengthDocument(0), clickNotified(false) {
+	lengthDocument(0), clickNotified(false), version(0) {
 }
 
 template <typename POS>
@@ -200,6 +212,10 @@ FillResult<Sci::Position> DecorationList<POS>::FillRange(Sci::Position position,
 	// Converting result from POS to Sci::Position as callers not polymorphic.
 	const FillResult<POS> frInPOS = current->rs.FillRange(pos_cast(position), value, pos_cast(fillLength));
 	const FillResult<Sci::Position> fr { frInPOS.changed, frInPOS.position, frInPOS.fillLength };
+	if (fr.changed) {
+		version++;
+		SetAllOnBit(currentIndicator, value, fr.position, fr.fillLength);
+	}
 	if (current->Empty()) {
 		Delete(currentIndicator);
 	}
@@ -210,20 +226,26 @@ template <typename POS>
 void DecorationList<POS>::InsertSpace(Sci::Position position, Sci::Position insertLength) {
 	const bool atEnd = position == lengthDocument;
 	lengthDocument += insertLength;
+	version++;
 	for (const std::unique_ptr<Decoration<POS>> &deco : decorationList) {
 		deco->rs.InsertSpace(pos_cast(position), pos_cast(insertLength));
 		if (atEnd) {
 			deco->rs.FillRange(pos_cast(position), 0, pos_cast(insertLength));
 		}
 	}
+	// Each decoration has one value over the inserted space so the mask is uniform there
+	allOn.InsertSpace(pos_cast(position), pos_cast(insertLength));
+	allOn.FillRange(pos_cast(position), MaskAt(position), pos_cast(insertLength));
 }
 
 template <typename POS>
 void DecorationList<POS>::DeleteRange(Sci::Position position, Sci::Position deleteLength) {
 	lengthDocument -= deleteLength;
+	version++;
 	for (const std::unique_ptr<Decoration<POS>> &deco : decorationList) {
 		deco->rs.DeleteRange(pos_cast(position), pos_cast(deleteLength));
 	}
+	allOn.DeleteRange(pos_cast(position), pos_cast(deleteLength));
 	DeleteAnyEmpty();
 	if (decorationList.size() != decorationView.size()) {
 		// One or more empty decorations deleted so update view.
@@ -240,6 +262,7 @@ void DecorationList<POS>::DeleteLexerDecorations() {
 	}), decorationList.end());
 	current = nullptr;
 	SetView();
+	RebuildAllOn();
 }
 
 template <typename POS>
@@ -256,6 +279,7 @@ void DecorationList<POS>::DeleteAnyEmpty() {
 
 template <typename POS>
 void DecorationList<POS>::SetView() {
+	version++;
 	decorationView.clear();
 	for (const std::unique_ptr<Decoration<POS>> &deco : decorationList) {
 		decorationView.push_back(deco.get());
@@ -263,7 +287,7 @@ void DecorationList<POS>::SetView() {
 }
 
 template <typename POS>
-int DecorationList<POS>::AllOnFor(Sci::Position position) const noexcept {
+int DecorationList<POS>::MaskAt(Sci::Position position) const noexcept {
 	int mask = 0;
 	for (const std::unique_ptr<Decoration<POS>> &deco : decorationList) {
 		if (deco->rs.ValueAt(pos_cast(position))) {
@@ -275,6 +299,51 @@ int DecorationList<POS>::AllOnFor(Sci::Position position) const noexcept {
 	return mask;
 }
 
+template <typename POS>
+void DecorationList<POS>::SetAllOnBit(int indicator, int value, Sci::Position position, Sci::Position fillLength) {
+	if (indicator >= static_cast<int>(Scintilla::IndicatorNumbers::Ime)) {
+		return;
+	}
+	const int bit = 1u << indicator;
+	const Sci::Position end = position + fillLength;
+	while (position < end) {
+		const int mask = allOn.ValueAt(pos_cast(position));
+		const Sci::Position endRun = std::min<Sci::Position>(allOn.EndRun(pos_cast(position)), end);
+		const int maskNew = value ? (mask | bit) : (mask & ~bit);
+		if (maskNew != mask) {
+			allOn.FillRange(pos_cast(position), maskNew, pos_cast(endRun - position));
+		}
+		position = endRun;
+	}
+}
+
+template <typename POS>
+void DecorationList<POS>::RebuildAllOn() {
+	allOn.DeleteAll();
+	allOn.InsertSpace(0, pos_cast(lengthDocument));
+	for (const std::unique_ptr<Decoration<POS>> &deco : decorationList) {
+		Sci::Position position = 0;
+		while (position < lengthDocument) {
+			const Sci::Position endRun = deco->rs.EndRun(pos_cast(position));
+			const int value = deco->rs.ValueAt(pos_cast(position));
+			if (value) {
+				SetAllOnBit(deco->Indicator(), value, position, endRun - position);
+			}
+			position = endRun;
+		}
+	}
+}
+
+template <typename POS>
+int DecorationList<POS>::AllOnFor(Sci::Position position) const noexcept {
+	return allOn.ValueAt(pos_cast(position));
+}
+
+template <typename POS>
+Sci::Position DecorationList<POS>::AllOnEnd(Sci::Position position) const noexcept {
+	return allOn.EndRun(pos_cast(position));
+}
+
 template <typename POS>
 int DecorationList<POS>::ValueAt(int indicator, Sci::Position position) noexcept {
 	const Decoration<POS> *deco = DecorationFromIndicator(indicator);
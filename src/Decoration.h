@@ -42,12 +42,17 @@ public:
 	virtual void DeleteLexerDecorations() = 0;
 
 	virtual int AllOnFor(Sci::Position position) const noexcept = 0;
+	// Position after position where the set of indicators on may change
+	virtual Sci::Position AllOnEnd(Sci::Position position) const noexcept = 0;
 	virtual int ValueAt(int indicator, Sci::Position position) noexcept = 0;
 	virtual Sci::Position Start(int indicator, Sci::Position position) noexcept = 0;
 	virtual Sci::Position End(int indicator, Sci::Position position) noexcept = 0;
 
 	virtual bool ClickNotified() const noexcept = 0;
 	virtual void SetClickNotified(bool notified) noexcept = 0;
+
+	// Changes whenever any decoration may have changed so views can cache runs
+	virtual unsigned int Version() const noexcept = 0;
 };
 
 std::unique_ptr<IDecoration> DecorationCreate(bool largeDocument, int indicator);
@@ -304,6 +304,11 @@ void Document::TentativeUndo() {
 			const int steps = cb.TentativeSteps();
 			//Platform::DebugPrintf("Steps=%d\n", steps);
 			for (int step = 0; step < steps; step++) {
+				if (cb.UndoStepIsReplacement() && (step + 1 < steps)) {
+					step++;
+					UndoReplacement(step == steps - 1, multiLine);
+					continue;
+				}
 				const Sci::Line prevLinesTotal = LinesTotal();
 				const Action action = cb.GetUndoStep();
 				if (action.at == ActionType::remove) {
@@ -1277,6 +1282,180 @@ void Document::CheckReadOnly() {
 	}
 }
 
+namespace {
+
+// Compare in blocks with memcmp which is vectorized by the runtime library then
+// find the first difference inside the mismatching block.
+constexpr size_t diffBlockSize = 256;
+
+size_t CommonPrefixLength(Sci::string_view a, Sci::string_view b) noexcept {
+	const size_t length = std::min(a.length(), b.length());
+	size_t common = 0;
+	while ((common + diffBlockSize <= length) && (memcmp(a.data() + common, b.data() + common, diffBlockSize) == 0)) {
+		common += diffBlockSize;
+	}
+	while ((common < length) && (a[common] == b[common])) {
+		common++;
+	}
+	return common;
+}
+
+size_t CommonSuffixLength(Sci::string_view a, Sci::string_view b) noexcept {
+	const size_t length = std::min(a.length(), b.length());
+	size_t common = 0;
+	while ((common + diffBlockSize <= length) &&
+		(memcmp(a.data() + a.length() - common - diffBlockSize, b.data() + b.length() - common - diffBlockSize, diffBlockSize) == 0)) {
+		common += diffBlockSize;
+	}
+	while ((common < length) && (a[a.length() - common - 1] == b[b.length() - common - 1])) {
+		common++;
+	}
+	return common;
+}
+
+// Does the suffix of text with this length start at the beginning of a line?
+bool AfterLineEnd(Sci::string_view text, size_t suffix) noexcept {
+	return (suffix == text.length()) || IsEOLCharacter(text[text.length() - suffix - 1]);
+}
+
+struct DiffLine {
+	size_t start;
+	size_t hash;
+};
+
+// Split text into lines, each including its line end, with a final entry marking the end of text.
+std::vector<DiffLine> HashLines(Sci::string_view text) {
+	std::vector<DiffLine> lines;
+	size_t start = 0;
+	size_t hash = 2166136261U;
+	for (size_t i = 0; i < text.length(); i++) {
+		const unsigned char ch = text[i];
+		hash = (hash ^ ch) * 16777619U;
+		if ((ch == '\n') || ((ch == '\r') && ((i + 1 == text.length()) || (text[i + 1] != '\n')))) {
+			lines.push_back({start, hash});
+			start = i + 1;
+			hash = 2166136261U;
+		}
+	}
+	if (start < text.length()) {
+		lines.push_back({start, hash});
+	}
+	lines.push_back({text.length(), 0});
+	return lines;
+}
+
+class LineSequence {
+	Sci::string_view text;
+	std::vector<DiffLine> lines;
+public:
+	explicit LineSequence(Sci::string_view text_) : text(text_), lines(HashLines(text_)) {
+	}
+	ptrdiff_t Lines() const noexcept {
+		return lines.size() - 1;
+	}
+	size_t Start(ptrdiff_t line) const noexcept {
+		return lines[line].start;
+	}
+	Sci::string_view Line(ptrdiff_t line) const {
+		return text.substr(lines[line].start, lines[line + 1].start - lines[line].start);
+	}
+	bool Same(ptrdiff_t line, const LineSequence &other, ptrdiff_t lineOther) const {
+		return (lines[line].hash == other.lines[lineOther].hash) && (Line(line) == other.Line(lineOther));
+	}
+};
+
+// Range of lines [oldFirst, oldLast) replaced by [newFirst, newLast).
+struct DiffHunk {
+	ptrdiff_t oldFirst;
+	ptrdiff_t oldLast;
+	ptrdiff_t newFirst;
+	ptrdiff_t newLast;
+};
+
+// Line edits beyond this are not worth the quadratic trace memory so are treated as one hunk.
+constexpr ptrdiff_t diffEditsMaximum = 1000;
+
+// Myers O(ND) difference, finding the hunks between runs of matching lines.
+std::vector<DiffHunk> DiffLines(const LineSequence &oldLines, const LineSequence &newLines) {
+	const ptrdiff_t n = oldLines.Lines();
+	const ptrdiff_t m = newLines.Lines();
+	const ptrdiff_t editsLimit = std::min(n + m, diffEditsMaximum);
+	// trace[d][k + d] is the furthest old line reached on diagonal k with d edits
+	std::vector<std::vector<ptrdiff_t>> trace;
+	bool reached = false;
+	for (ptrdiff_t d = 0; (d <= editsLimit) && !reached; d++) {
+		std::vector<ptrdiff_t> furthest(2 * d + 1);
+		for (ptrdiff_t k = -d; k <= d; k += 2) {
+			ptrdiff_t x = 0;
+			if (d > 0) {
+				const std::vector<ptrdiff_t> &previous = trace.back();
+				if ((k == -d) || ((k != d) && (previous[k - 1 + d - 1] < previous[k + 1 + d - 1])))
+					x = previous[k + 1 + d - 1];
+				else
+					x = previous[k - 1 + d - 1] + 1;
+			}
+			ptrdiff_t y = x - k;
+			while ((x < n) && (y < m) && oldLines.Same(x, newLines, y)) {
+				x++;
+				y++;
+			}
+			furthest[k + d] = x;
+			if ((x >= n) && (y >= m)) {
+				reached = true;
+				break;
+			}
+		}
+		trace.push_back(std::move(furthest));
+	}
+	if (!reached) {
+		return { {0, n, 0, m} };
+	}
+
+	// Backtrack collecting matching runs as (old start, new start, length) in reverse order
+	struct Run {
+		ptrdiff_t x;
+		ptrdiff_t y;
+		ptrdiff_t length;
+	};
+	std::vector<Run> runs;
+	ptrdiff_t x = n;
+	ptrdiff_t y = m;
+	for (ptrdiff_t d = trace.size() - 1; d > 0; d--) {
+		const std::vector<ptrdiff_t> &previous = trace[d - 1];
+		const ptrdiff_t k = x - y;
+		const bool down = (k == -d) || ((k != d) && (previous[k - 1 + d - 1] < previous[k + 1 + d - 1]));
+		const ptrdiff_t kPrevious = down ? k + 1 : k - 1;
+		const ptrdiff_t xPrevious = previous[kPrevious + d - 1];
+		const ptrdiff_t yPrevious = xPrevious - kPrevious;
+		const ptrdiff_t xSnake = down ? xPrevious : xPrevious + 1;
+		if (x > xSnake) {
+			runs.push_back({xSnake, xSnake - k, x - xSnake});
+		}
+		x = xPrevious;
+		y = yPrevious;
+	}
+	if (x > 0) {
+		runs.push_back({0, 0, x});
+	}
+
+	std::vector<DiffHunk> hunks;
+	ptrdiff_t oldPosition = 0;
+	ptrdiff_t newPosition = 0;
+	for (auto it = runs.rbegin(); it != runs.rend(); ++it) {
+		if ((it->x > oldPosition) || (it->y > newPosition)) {
+			hunks.push_back({oldPosition, it->x, newPosition, it->y});
+		}
+		oldPosition = it->x + it->length;
+		newPosition = it->y + it->length;
+	}
+	if ((oldPosition < n) || (newPosition < m)) {
+		hunks.push_back({oldPosition, n, newPosition, m});
+	}
+	return hunks;
+}
+
+}
+
 void Document::TrimReplacement(Sci::string_view &text, Range &range) const noexcept {
 	while (!text.empty() && !range.Empty() && (text.front() == CharAt(range.start))) {
 		text.remove_prefix(1);
@@ -1288,6 +1467,71 @@ void Document::TrimReplacement(Sci::string_view &text, Range &range) const noexc
 	}
 }
 
+/**
+ * Replace range with text by only changing the lines that differ, found with a diff over
+ * hashed lines after trimming the common prefix and suffix.
+ * Markers, folds, annotations and change history of unchanged lines survive and the edits
+ * form a single undo action.
+ * On return, range covers the replaced text as it is in the document, which is only
+ * the new text when every edit succeeded.
+ * Returns the number of separate edits made.
+ */
+Sci::Position Document::ReplaceWithDiff(Range &range, Sci::string_view text) {
+	std::string current(range.Length(), '\0');
+	GetCharRange(&current[0], range.start, range.Length());
+	Sci::string_view oldText(current);
+	// Trim whole lines so that the remaining lines of both texts stay aligned
+	size_t prefix = CommonPrefixLength(oldText, text);
+	while ((prefix > 0) && !IsEOLCharacter(oldText[prefix - 1])) {
+		prefix--;
+	}
+	oldText.remove_prefix(prefix);
+	text.remove_prefix(prefix);
+	size_t suffix = CommonSuffixLength(oldText, text);
+	while ((suffix > 0) && !(AfterLineEnd(oldText, suffix) && AfterLineEnd(text, suffix))) {
+		suffix--;
+	}
+	oldText.remove_suffix(suffix);
+	text.remove_suffix(suffix);
+	if (oldText.empty() && text.empty())
+		return 0;
+
+	const LineSequence oldLines(oldText);
+	const LineSequence newLines(text);
+	const std::vector<DiffHunk> hunks = DiffLines(oldLines, newLines);
+
+	UndoGroup ug(this);
+	const Sci::Position start = range.start + prefix;
+	Sci::Position lengthChange = 0;
+	Sci::Position edits = 0;
+	// Apply from the end so earlier positions are unaffected
+	for (auto it = hunks.rbegin(); it != hunks.rend(); ++it) {
+		const size_t oldStart = oldLines.Start(it->oldFirst);
+		const size_t newStart = newLines.Start(it->newFirst);
+		Sci::string_view oldPart = oldText.substr(oldStart, oldLines.Start(it->oldLast) - oldStart);
+		Sci::string_view newPart = text.substr(newStart, newLines.Start(it->newLast) - newStart);
+		const size_t prefixHunk = CommonPrefixLength(oldPart, newPart);
+		oldPart.remove_prefix(prefixHunk);
+		newPart.remove_prefix(prefixHunk);
+		const size_t suffixHunk = CommonSuffixLength(oldPart, newPart);
+		oldPart.remove_suffix(suffixHunk);
+		newPart.remove_suffix(suffixHunk);
+		const Sci::Position position = start + oldStart + prefixHunk;
+		if (!oldPart.empty()) {
+			if (!DeleteChars(position, oldPart.length()))
+				break;
+			lengthChange -= oldPart.length();
+		}
+		// An insertion fails when read-only but may also be changed by an InsertCheck handler
+		const Sci::Position lengthInserted = InsertString(position, newPart);
+		lengthChange += lengthInserted;
+		if (!oldPart.empty() || (lengthInserted > 0))
+			edits++;
+	}
+	range.end += lengthChange;
+	return edits;
+}
+
 // Document only modified by gateways DeleteChars, InsertString, Undo, Redo, and SetStyleAt.
 // SetStyleAt does not change the persistent state of a document
 
@@ -1386,6 +1630,50 @@ Sci::Position Document::InsertString(Sci::Position position, Sci::string_view sv
 	return InsertString(position, sv.data(), sv.length());
 }
 
+/**
+ * Replace len bytes at pos with text as one change when both have the same line ends so
+ * lines are kept with their markers, folds and annotations and undo holds one step.
+ * As with undo, there is no InsertCheck notification.
+ * Returns false without changing the document when the replacement would add, remove,
+ * join or split lines so that the caller can fall back to DeleteChars and InsertString.
+ */
+bool Document::ReplaceKeepingLines(Sci::Position pos, Sci::Position len, Sci::string_view text) {
+	if ((pos < 0) || (len <= 0) || ((pos + len) > LengthNoExcept()))
+		return false;
+	CheckReadOnly();
+	if ((enteredModification != 0) || cb.IsReadOnly())
+		return false;
+	std::string removed(len, '\0');
+	cb.GetCharRange(&removed[0], pos, len);
+	if (!cb.ReplaceKeepsLines(pos, removed, text))
+		return false;
+	enteredModification++;
+	NotifyModified(
+		DocModification(
+			ModificationFlags::BeforeDelete | ModificationFlags::User,
+			pos, len,
+			0, nullptr));
+	NotifyModified(
+		DocModification(
+			ModificationFlags::BeforeInsert | ModificationFlags::User,
+			pos, text.length(),
+			0, text.data()));
+	const bool startSavePoint = cb.IsSavePoint();
+	bool startSequence = false;
+	std::vector<LineChange> changes;
+	cb.ReplaceKeepingLines(pos, removed, text, changes, startSequence);
+	if (startSavePoint && cb.IsCollectingUndo())
+		NotifySavePoint(false);
+	ModifiedAt(pos);
+	NotifyReplacement(pos,
+		Action(ActionType::remove, false, pos, removed.data(), len),
+		Action(ActionType::insert, false, pos, text.data(), text.length()),
+		changes, false,
+		ModificationFlags::User | (startSequence ? ModificationFlags::StartAction : ModificationFlags::None));
+	enteredModification--;
+	return true;
+}
+
 void Document::ChangeInsertion(const char *s, Sci::Position length) {
 	insertionSet = true;
 	insertion.assign(s, length);
@@ -1423,6 +1711,12 @@ Sci::Position Document::Undo() {
 			//Platform::DebugPrintf("Steps=%d\n", steps);
 			Range coalescedRemove;	// Default is empty at 0
 			for (int step = 0; step < steps; step++) {
+				if (cb.UndoStepIsReplacement() && (step + 1 < steps)) {
+					step++;
+					newPos = UndoReplacement(step == steps - 1, multiLine);
+					coalescedRemove = Range();
+					continue;
+				}
 				const Sci::Line prevLinesTotal = LinesTotal();
 				const Action action = cb.GetUndoStep();
 				if (action.at == ActionType::remove) {
@@ -1490,6 +1784,11 @@ Sci::Position Document::Redo() {
 			bool multiLine = false;
 			const int steps = cb.StartRedo();
 			for (int step = 0; step < steps; step++) {
+				if (cb.RedoStepIsReplacement() && (step + 1 < steps)) {
+					step++;
+					newPos = RedoReplacement(step == steps - 1, multiLine);
+					continue;
+				}
 				const Sci::Line prevLinesTotal = LinesTotal();
 				const Action action = cb.GetRedoStep();
 				if (action.at == ActionType::insert) {
@@ -1603,17 +1902,31 @@ Sci::Position Document::SetLineIndentation(Sci::Line line, Sci::Position indent)
 	if (indent < 0)
 		indent = 0;
 	if (indent != indentOfLine) {
-		const std::string linebuf = CreateIndentation(indent, tabInChars, !useTabs);
-		const Sci::Position thisLineStart = LineStart(line);
-		const Sci::Position indentPos = GetLineIndentPosition(line);
 		UndoGroup ug(this);
-		DeleteChars(thisLineStart, indentPos - thisLineStart);
-		return thisLineStart + InsertString(thisLineStart, linebuf);
+		return ReplaceIndentation(LineStart(line), GetLineIndentPosition(line),
+			CreateIndentation(indent, tabInChars, !useTabs));
 	} else {
 		return GetLineIndentPosition(line);
 	}
 }
 
+// Replace the indentation between lineStart and indentPos but only change the part after any
+// common prefix so indenting with spaces is just an insertion and dedenting just a deletion.
+// Returns the new indent position.
+Sci::Position Document::ReplaceIndentation(Sci::Position lineStart, Sci::Position indentPos, const std::string &indentation) {
+	Sci::Position common = 0;
+	const Sci::Position lengthIndentation = indentation.length();
+	while ((lineStart + common < indentPos) && (common < lengthIndentation) &&
+		(cb.CharAt(lineStart + common) == indentation[common])) {
+		common++;
+	}
+	const Sci::Position position = lineStart + common;
+	if (indentPos > position) {
+		DeleteChars(position, indentPos - position);
+	}
+	return position + InsertString(position, indentation.c_str() + common, lengthIndentation - common);
+}
+
 Sci::Position Document::GetLineIndentPosition(Sci::Line line) const {
 	if (line < 0)
 		return 0;
@@ -1705,16 +2018,64 @@ Sci::Position Document::FindColumn(Sci::Line line, Sci::Position column) {
 
 void Document::Indent(bool forwards, Sci::Line lineBottom, Sci::Line lineTop) {
 	// Dedent - suck white space off the front of the line to dedent by equivalent of a tab
-	for (Sci::Line line = lineBottom; line >= lineTop; line--) {
-		const Sci::Position indentOfLine = GetLineIndentation(line);
-		if (forwards) {
-			if (LineStart(line) < LineEnd(line)) {
-				SetLineIndentation(line, indentOfLine + IndentSize());
-			}
-		} else {
-			SetLineIndentation(line, indentOfLine - IndentSize());
+	// Each line's indentation is measured in one scan. When several lines change, the text from
+	// the first to the last changed indentation is rebuilt in one pass and applied as a single
+	// change that keeps the lines so markers, folds and line states stay on their lines.
+	// If that is refused, the changed part of each line is replaced separately from the bottom.
+	struct LineIndentation {
+		Sci::Position lineStart;
+		Sci::Position indentPos;
+		std::string indentation;
+	};
+	std::vector<LineIndentation> changed;
+	const int indentSize = IndentSize();
+	for (Sci::Line line = lineTop; line <= lineBottom; line++) {
+		const Sci::Position lineStart = LineStart(line);
+		const Sci::Position lineEnd = LineEnd(line);
+		if (forwards && (lineStart >= lineEnd)) {
+			continue;
+		}
+		Sci::Position indentOfLine = 0;
+		Sci::Position indentPos = lineStart;
+		for (; indentPos < lineEnd; indentPos++) {
+			const char ch = cb.CharAt(indentPos);
+			if (ch == ' ')
+				indentOfLine++;
+			else if (ch == '\t')
+				indentOfLine = NextTab(indentOfLine, tabInChars);
+			else
+				break;
+		}
+		const Sci::Position indent = std::max<Sci::Position>(indentOfLine + (forwards ? indentSize : -indentSize), 0);
+		if (indent != indentOfLine) {
+			changed.push_back({lineStart, indentPos, CreateIndentation(indent, tabInChars, !useTabs)});
 		}
 	}
+	if (changed.empty())
+		return;
+
+	if (changed.size() > 1) {
+		const Sci::Position startBlock = changed.front().lineStart;
+		const Sci::Position lengthBlock = changed.back().indentPos - startBlock;
+		std::string current(lengthBlock, '\0');
+		cb.GetCharRange(&current[0], startBlock, lengthBlock);
+		std::string text;
+		text.reserve(lengthBlock + changed.size() * indentSize);
+		size_t offset = 0;
+		for (const LineIndentation &li : changed) {
+			const size_t offsetLine = li.lineStart - startBlock;
+			text.append(current, offset, offsetLine - offset);
+			text.append(li.indentation);
+			offset = li.indentPos - startBlock;
+		}
+		if (ReplaceKeepingLines(startBlock, lengthBlock, text))
+			return;
+	}
+
+	UndoGroup ug(this);
+	for (auto it = changed.rbegin(); it != changed.rend(); ++it) {
+		ReplaceIndentation(it->lineStart, it->indentPos, it->indentation);
+	}
 }
 
 namespace {
@@ -2368,6 +2729,112 @@ const char *Document::SubstituteByPosition(const char *text, Sci::Position *leng
 		return nullptr;
 }
 
+/**
+ * Replace every match of search inside range with replacement, expanding \d patterns
+ * when searching for a regular expression.
+ * Matches are all found before any change. When matches are dense and the lines are kept,
+ * the text from the first match to the last is built in one pass and applied as a single
+ * change with ReplaceKeepingLines. Otherwise each match is applied from the end as a separate
+ * minimal edit inside one undo group so that undo only stores the replaced spans.
+ * Either way, text between matches keeps its markers, folds, annotations and change history.
+ * On return, range covers the original range adjusted for the change in length.
+ * Returns the number of replacements.
+ */
+Sci::Position Document::ReplaceAll(Range &range, const char *search, Sci::Position lengthSearch, Sci::string_view replacement, FindOption flags) {
+	if (lengthSearch <= 0 || range.Empty())
+		return 0;
+	const bool regExp = FlagSet(flags, FindOption::RegExp);
+	const Sci::Position endRange = range.end;
+	struct Replacement {
+		Sci::Position position;
+		Sci::Position length;
+		size_t start;	// Offset of the replacing text in substitutions
+		size_t end;
+	};
+	std::vector<Replacement> replacements;
+	std::string substitutions;
+	Sci::Position pos = range.start;
+	while (pos <= endRange) {
+		Sci::Position lengthFound = lengthSearch;
+		const Sci::Position found = FindText(pos, endRange, search, flags, &lengthFound);
+		if (found < 0 || found + lengthFound > endRange)
+			break;
+		const size_t start = substitutions.length();
+		if (regExp) {
+			Sci::Position lengthSubstituted = replacement.length();
+			const char *substituted = SubstituteByPosition(replacement.data(), &lengthSubstituted);
+			if (substituted)
+				substitutions.append(substituted, lengthSubstituted);
+		} else {
+			substitutions.append(replacement.data(), replacement.length());
+		}
+		replacements.push_back({found, lengthFound, start, substitutions.length()});
+		const Sci::Position endFound = found + lengthFound;
+		if (lengthFound == 0) {
+			// Empty match: step over a character so the search progresses
+			if (endFound >= endRange)
+				break;
+			pos = NextPosition(endFound, 1);
+		} else {
+			pos = endFound;
+		}
+	}
+	if (replacements.empty())
+		return 0;
+
+	// A single change copies the text between matches into undo history so is only worth it
+	// when that text is short compared with the cost of an edit and notifications per match
+	constexpr Sci::Position bytesPerReplacementForSingleChange = 256;
+	const Sci::Position startSpan = replacements.front().position;
+	const Sci::Position lengthSpan = replacements.back().position + replacements.back().length - startSpan;
+	if ((replacements.size() > 1) &&
+		(lengthSpan <= bytesPerReplacementForSingleChange * static_cast<Sci::Position>(replacements.size()))) {
+		std::string current(lengthSpan, '\0');
+		cb.GetCharRange(&current[0], startSpan, lengthSpan);
+		std::string text;
+		text.reserve(lengthSpan + substitutions.length());
+		size_t offset = 0;
+		for (const Replacement &match : replacements) {
+			const size_t offsetMatch = match.position - startSpan;
+			text.append(current, offset, offsetMatch - offset);
+			text.append(substitutions, match.start, match.end - match.start);
+			offset = offsetMatch + match.length;
+		}
+		if (ReplaceKeepingLines(startSpan, lengthSpan, text)) {
+			range.end = endRange + text.length() - lengthSpan;
+			return replacements.size();
+		}
+	}
+
+	UndoGroup ug(this);
+	Sci::Position lengthChange = 0;
+	Sci::Position replaced = 0;
+	std::string matched;
+	// Apply from the end so earlier positions are unaffected
+	for (auto it = replacements.rbegin(); it != replacements.rend(); ++it) {
+		matched.resize(it->length);
+		cb.GetCharRange(&matched[0], it->position, it->length);
+		Sci::string_view oldPart(matched);
+		Sci::string_view newPart = Sci::string_view(substitutions).substr(it->start, it->end - it->start);
+		const size_t prefix = CommonPrefixLength(oldPart, newPart);
+		oldPart.remove_prefix(prefix);
+		newPart.remove_prefix(prefix);
+		const size_t suffix = CommonSuffixLength(oldPart, newPart);
+		oldPart.remove_suffix(suffix);
+		newPart.remove_suffix(suffix);
+		const Sci::Position position = it->position + prefix;
+		if (!oldPart.empty()) {
+			if (!DeleteChars(position, oldPart.length()))
+				break;
+			lengthChange -= oldPart.length();
+		}
+		lengthChange += InsertString(position, newPart);
+		replaced++;
+	}
+	range.end = endRange + lengthChange;
+	return replaced;
+}
+
 LineCharacterIndexType Document::LineCharacterIndex() const noexcept {
 	return cb.LineCharacterIndex();
 }
@@ -2690,11 +3157,88 @@ void Document::NotifyModified(DocModification mh) {
 	} else if (FlagSet(mh.modificationType, ModificationFlags::DeleteText)) {
 		decorations->DeleteRange(mh.position, mh.length);
 	}
+	NotifyWatchersModified(mh);
+}
+
+void Document::NotifyWatchersModified(const DocModification &mh) {
 	for (const WatcherWithUserData &watcher : watchers) {
 		watcher.watcher->NotifyModified(this, mh, watcher.userData);
 	}
 }
 
+// A replacement that kept lines is reported to watchers as a deletion then an insertion of
+// the whole text but decorations only change over the changed part of each line.
+void Document::NotifyReplacement(Sci::Position position, const Action &deleted, const Action &inserted,
+	const std::vector<LineChange> &changes, bool undoing, ModificationFlags flags, ModificationFlags flagsLast) {
+	if (undoing) {
+		// Forwards since undoing each line restores the positions after it
+		for (const LineChange &change : changes) {
+			if (change.lengthInserted)
+				decorations->DeleteRange(change.position, change.lengthInserted);
+			if (change.lengthRemoved)
+				decorations->InsertSpace(change.position, change.lengthRemoved);
+		}
+	} else {
+		for (auto it = changes.rbegin(); it != changes.rend(); ++it) {
+			if (it->lengthRemoved)
+				decorations->DeleteRange(it->position, it->lengthRemoved);
+			if (it->lengthInserted)
+				decorations->InsertSpace(it->position, it->lengthInserted);
+		}
+	}
+	NotifyWatchersModified(DocModification(flags | ModificationFlags::DeleteText,
+		position, deleted.lenData, 0, deleted.data));
+	// flagsLast marks the final step of an undo or redo so only goes on the second notification
+	NotifyWatchersModified(DocModification(flags | flagsLast | ModificationFlags::InsertText,
+		position, inserted.lenData, 0, inserted.data));
+}
+
+// Undo a removal and the insertion that replaced it with ReplaceKeepingLines as one step.
+// Returns the position after the restored text.
+Sci::Position Document::UndoReplacement(bool lastStep, bool multiLine) {
+	const Action insertion = cb.GetUndoStep();
+	const Action removal = cb.GetUndoReplacedStep();
+	NotifyModified(DocModification(
+					ModificationFlags::BeforeDelete | ModificationFlags::Undo, insertion));
+	NotifyModified(DocModification(
+					ModificationFlags::BeforeInsert | ModificationFlags::Undo, removal));
+	std::vector<LineChange> changes;
+	cb.PerformUndoReplacement(changes);
+	ModifiedAt(removal.position);
+	ModificationFlags flagsLast = ModificationFlags::None;
+	if (lastStep) {
+		flagsLast |= ModificationFlags::LastStepInUndoRedo;
+		if (multiLine)
+			flagsLast |= ModificationFlags::MultilineUndoRedo;
+	}
+	NotifyReplacement(removal.position, insertion, removal, changes, true,
+		ModificationFlags::Undo | ModificationFlags::MultiStepUndoRedo, flagsLast);
+	return removal.position + removal.lenData;
+}
+
+// Redo a removal and the insertion that replaced it with ReplaceKeepingLines as one step.
+// Returns the position after the inserted text.
+Sci::Position Document::RedoReplacement(bool lastStep, bool multiLine) {
+	const Action removal = cb.GetRedoStep();
+	const Action insertion = cb.GetRedoReplacingStep();
+	NotifyModified(DocModification(
+					ModificationFlags::BeforeDelete | ModificationFlags::Redo, removal));
+	NotifyModified(DocModification(
+					ModificationFlags::BeforeInsert | ModificationFlags::Redo, insertion));
+	std::vector<LineChange> changes;
+	cb.PerformRedoReplacement(changes);
+	ModifiedAt(insertion.position);
+	ModificationFlags flagsLast = ModificationFlags::None;
+	if (lastStep) {
+		flagsLast |= ModificationFlags::LastStepInUndoRedo;
+		if (multiLine)
+			flagsLast |= ModificationFlags::MultilineUndoRedo;
+	}
+	NotifyReplacement(insertion.position, removal, insertion, changes, false,
+		ModificationFlags::Redo | ModificationFlags::MultiStepUndoRedo, flagsLast);
+	return insertion.position + insertion.lenData;
+}
+
 bool Document::IsWordPartSeparator(unsigned int ch) const {
 	return (WordCharacterClass(ch) == CharacterClass::word) && IsPunctuation(ch);
 }
@@ -378,9 +378,11 @@ public:
 	void ModifiedAt(Sci::Position pos) noexcept;
 	void CheckReadOnly();
 	void TrimReplacement(Sci::string_view &text, Range &range) const noexcept;
+	Sci::Position ReplaceWithDiff(Range &range, Sci::string_view text);
 	bool DeleteChars(Sci::Position pos, Sci::Position len);
 	Sci::Position InsertString(Sci::Position position, const char *s, Sci::Position insertLength);
 	Sci::Position InsertString(Sci::Position position, Sci::string_view sv);
+	bool ReplaceKeepingLines(Sci::Position pos, Sci::Position len, Sci::string_view text);
 	void ChangeInsertion(const char *s, Sci::Position length);
 	int SCI_METHOD AddData(const char *data, Sci_Position length) override;
 	IDocumentEditable *AsDocumentEditable() noexcept;
@@ -433,6 +435,7 @@ public:
 
 	int SCI_METHOD GetLineIndentation(Sci_Position line) override;
 	Sci::Position SetLineIndentation(Sci::Line line, Sci::Position indent);
+	Sci::Position ReplaceIndentation(Sci::Position lineStart, Sci::Position indentPos, const std::string &indentation);
 	Sci::Position GetLineIndentPosition(Sci::Line line) const;
 	Sci::Position GetColumn(Sci::Position pos) const;
 	Sci::Position CountCharacters(Sci::Position startPos, Sci::Position endPos) const noexcept;
@@ -509,6 +512,7 @@ public:
 	void SetCaseFolder(std::unique_ptr<CaseFolder> pcf_) noexcept;
 	Sci::Position FindText(Sci::Position minPos, Sci::Position maxPos, const char *search, Scintilla::FindOption flags, Sci::Position *length);
 	const char *SubstituteByPosition(const char *text, Sci::Position *length);
+	Sci::Position ReplaceAll(Range &range, const char *search, Sci::Position lengthSearch, Sci::string_view replacement, Scintilla::FindOption flags);
 	Scintilla::LineCharacterIndexType LineCharacterIndex() const noexcept;
 	void AllocateLineCharacterIndex(Scintilla::LineCharacterIndexType lineCharacterIndex);
 	void ReleaseLineCharacterIndex(Scintilla::LineCharacterIndexType lineCharacterIndex);
@@ -574,6 +578,12 @@ private:
 	void NotifyModifyAttempt();
 	void NotifySavePoint(bool atSavePoint);
 	void NotifyModified(DocModification mh);
+	void NotifyWatchersModified(const DocModification &mh);
+	void NotifyReplacement(Sci::Position position, const Action &deleted, const Action &inserted,
+		const std::vector<LineChange> &changes, bool undoing, Scintilla::ModificationFlags flags,
+		Scintilla::ModificationFlags flagsLast=Scintilla::ModificationFlags::None);
+	Sci::Position UndoReplacement(bool lastStep, bool multiLine);
+	Sci::Position RedoReplacement(bool lastStep, bool multiLine);
 };
 
 class UndoGroup {
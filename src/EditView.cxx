@@ -73,6 +73,51 @@ PrintParameters::PrintParameters() noexcept {
 	wrapState = Wrap::Word;
 }
 
+void PrintPagination::Clear() noexcept {
+	pdoc = nullptr;
+	lineFirst = 0;
+	subLineStarts.clear();
+}
+
+void PrintPagination::Reset(const Document *pdoc_, int width_, int zoomLevel_, Wrap wrapState_, int logPixelsY_,
+	Sci::Line lineFirst_, Sci::Line lines) {
+	pdoc = pdoc_;
+	width = width_;
+	zoomLevel = zoomLevel_;
+	wrapState = wrapState_;
+	logPixelsY = logPixelsY_;
+	lineFirst = lineFirst_;
+	subLineStarts.clear();
+	subLineStarts.resize(lines);
+}
+
+bool PrintPagination::Matches(const Document *pdoc_, int width_, int zoomLevel_, Wrap wrapState_, int logPixelsY_) const noexcept {
+	return pdoc && (pdoc == pdoc_) && (width == width_) && (zoomLevel == zoomLevel_) &&
+		(wrapState == wrapState_) && (logPixelsY == logPixelsY_);
+}
+
+bool PrintPagination::Contains(Sci::Line line) const noexcept {
+	return pdoc && (line >= lineFirst) && (line < lineFirst + static_cast<Sci::Line>(subLineStarts.size()));
+}
+
+void PrintPagination::SetLine(Sci::Line line, const LineLayout &ll) {
+	std::vector<int> &starts = subLineStarts[line - lineFirst];
+	starts.clear();
+	for (int subLine = 1; subLine < ll.lines; subLine++) {
+		starts.push_back(ll.LineStart(subLine));
+	}
+}
+
+int PrintPagination::Lines(Sci::Line line) const noexcept {
+	return static_cast<int>(subLineStarts[line - lineFirst].size()) + 1;
+}
+
+int PrintPagination::LineStart(Sci::Line line, int subLine) const noexcept {
+	if (subLine <= 0)
+		return 0;
+	return subLineStarts[line - lineFirst][subLine - 1];
+}
+
 namespace {
 
 int WidthStyledText(Surface *surface, const ViewStyle &vs, int styleOffset,
@@ -266,6 +311,15 @@ void EditView::LinesAddedOrRemoved(Sci::Line lineOfPos, Sci::Line linesAdded) {
 			}
 		}
 	}
+	if (ldWidths) {
+		if (linesAdded > 0) {
+			ldWidths->InsertLines(lineOfPos, linesAdded);
+		} else {
+			for (Sci::Line line = (lineOfPos + -linesAdded) - 1; line >= lineOfPos; line--) {
+				ldWidths->RemoveLine(line);
+			}
+		}
+	}
 }
 
 void EditView::DropGraphics() noexcept {
@@ -337,7 +391,8 @@ void LayoutSegments(IPositionCache *pCache,
 	const std::vector<TextSegment> &segments,
 	std::atomic<uint32_t> &nextIndex,
 	const bool textUnicode,
-	const bool multiThreaded) {
+	const bool multiThreaded,
+	std::vector<SegmentMeasureRequest> *batch) {
 	while (true) {
 		const uint32_t i = nextIndex.fetch_add(1, std::memory_order_acq_rel);
 		if (i >= segments.size()) {
@@ -371,8 +426,14 @@ void LayoutSegments(IPositionCache *pCache,
 					// Over half the segments are single characters and of these about half are space characters.
 					positions[0] = vstyle.styles[styleSegment].spaceWidth;
 				} else {
-					pCache->MeasureWidths(surface, vstyle, styleSegment, textUnicode,
-						Sci::string_view(&ll->chars[ts.start], ts.length), positions, multiThreaded);
+					const Sci::string_view text(&ll->chars[ts.start], ts.length);
+					if (batch) {
+						// Measured together after all segments have been examined
+						batch->push_back({styleSegment, text, positions});
+					} else {
+						pCache->MeasureWidths(surface, vstyle, styleSegment, textUnicode,
+							text, positions, multiThreaded);
+					}
 				}
 			}
 		} else if (vstyle.styles[styleSegment].invisibleRepresentation[0]) {
@@ -438,8 +499,15 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 		} else {
 			ll->validity = LineLayout::ValidLevel::invalid;
 		}
+		// Only layouts from the cache are checked so count whether it could be reused.
+		// The counts are not atomic so layouts checked by concurrent threads are not counted.
+		if (!callerMultiThreaded) {
+			llc.CountChecked(ll->validity != LineLayout::ValidLevel::invalid);
+		}
 	}
 	if (ll->validity == LineLayout::ValidLevel::invalid) {
+		ll->ClearShapedText();
+		ll->ClearIndicatorRuns();
 		ll->widthLine = LineLayout::wrapWidthInfinite;
 		ll->lines = 1;
 		if (vstyle.edgeState == EdgeVisualStyle::Background) {
@@ -503,17 +571,27 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 			// If only 1 thread needed then use the main thread, else spin up multiple
 			const std::launch policy = (multiThreaded) ? std::launch::async : std::launch::deferred;
 
-			std::vector<std::future<void>> futures;
-			for (size_t th = 0; th < threads; th++) {
-				// Find relative positions of everything except for tabs
-				std::future<void> fut = std::async(policy,
-					[pCache, surface, &vstyle, &ll, &segments, &nextIndex, textUnicode, multiThreadedContext]() {
-					LayoutSegments(pCache, surface, vstyle, ll, segments, nextIndex, textUnicode, multiThreadedContext);
-				});
-				futures.push_back(std::move(fut));
-			}
-			for (const std::future<void> &f : futures) {
-				f.wait();
+			if (threads == 1 && textUnicode) {
+				// On a single thread, segments missing from the position cache are
+				// measured in one platform call which can shape them together.
+				std::vector<SegmentMeasureRequest> batch;
+				LayoutSegments(pCache, surface, vstyle, ll, segments, nextIndex, textUnicode, multiThreadedContext, &batch);
+				if (!batch.empty()) {
+					pCache->MeasureWidthsBatch(surface, vstyle, textUnicode, batch, multiThreadedContext);
+				}
+			} else {
+				std::vector<std::future<void>> futures;
+				for (size_t th = 0; th < threads; th++) {
+					// Find relative positions of everything except for tabs
+					std::future<void> fut = std::async(policy,
+						[pCache, surface, &vstyle, &ll, &segments, &nextIndex, textUnicode, multiThreadedContext]() {
+						LayoutSegments(pCache, surface, vstyle, ll, segments, nextIndex, textUnicode, multiThreadedContext, nullptr);
+					});
+					futures.push_back(std::move(fut));
+				}
+				for (const std::future<void> &f : futures) {
+					f.wait();
+				}
 			}
 		}
 
@@ -1975,23 +2053,22 @@ void DrawIndicators(Surface *surface, const EditModel &model, const ViewStyle &v
 	const Sci::Position lineStart = ll->LineStart(subLine);
 	const Sci::Position posLineEnd = posLineStart + lineEnd;
 
-	for (const IDecoration *deco : model.pdoc->decorations->View()) {
-		if (under == vsDraw.indicators[deco->Indicator()].under) {
-			Sci::Position startPos = posLineStart + lineStart;
-			while (startPos < posLineEnd) {
-				const Range rangeRun(deco->StartRun(startPos), deco->EndRun(startPos));
+	for (const LineLayout::IndicatorRuns &runsOfIndicator : ll->Indicators(model.pdoc, posLineStart)) {
+		const int indicatorNumber = runsOfIndicator.indicator;
+		if (under == vsDraw.indicators[indicatorNumber].under) {
+			for (const LineLayout::IndicatorRun &run : runsOfIndicator.runs) {
+				const Range rangeRun(posLineStart + run.start, posLineStart + run.end);
+				const Sci::Position startPos = std::max(rangeRun.start, posLineStart + lineStart);
 				const Sci::Position endPos = std::min(rangeRun.end, posLineEnd);
-				const int value = deco->ValueAt(startPos);
-				if (value) {
-					const bool hover = vsDraw.indicators[deco->Indicator()].IsDynamic() &&
+				if (startPos < endPos) {
+					const bool hover = vsDraw.indicators[indicatorNumber].IsDynamic() &&
 						rangeRun.ContainsCharacter(model.hoverIndicatorPos);
 					const Indicator::State state = hover ? Indicator::State::hover : Indicator::State::normal;
 					const Sci::Position posSecond = model.pdoc->MovePositionOutsideChar(rangeRun.First() + 1, 1);
-					DrawIndicator(deco->Indicator(), startPos - posLineStart, endPos - posLineStart,
+					DrawIndicator(indicatorNumber, startPos - posLineStart, endPos - posLineStart,
 						surface, vsDraw, ll, xStart, rcLine, posSecond - posLineStart, subLine, state,
-						value, model.BidirectionalEnabled(), tabWidthMinimumPixels);
+						run.value, model.BidirectionalEnabled(), tabWidthMinimumPixels);
 				}
-				startPos = endPos;
 			}
 		}
 	}
@@ -2160,14 +2237,14 @@ void EditView::DrawForeground(Surface *surface, const EditModel &model, const Vi
 			}
 			if (vsDraw.indicatorsSetFore) {
 				// At least one indicator sets the text colour so see if it applies to this segment
-				for (const IDecoration *deco : model.pdoc->decorations->View()) {
-					const int indicatorValue = deco->ValueAt(ts.start + posLineStart);
-					if (indicatorValue) {
-						const Indicator &indicator = vsDraw.indicators[deco->Indicator()];
+				for (const LineLayout::IndicatorRuns &runsOfIndicator : ll->Indicators(model.pdoc, posLineStart)) {
+					const LineLayout::IndicatorRun *run = runsOfIndicator.RunContaining(ts.start);
+					if (run) {
+						const int indicatorValue = run->value;
+						const Indicator &indicator = vsDraw.indicators[runsOfIndicator.indicator];
 						bool hover = false;
 						if (indicator.IsDynamic()) {
-							const Sci::Position startPos = ts.start + posLineStart;
-							const Range rangeRun(deco->StartRun(startPos), deco->EndRun(startPos));
+							const Range rangeRun(posLineStart + run->start, posLineStart + run->end);
 							hover =	rangeRun.ContainsCharacter(model.hoverIndicatorPos);
 						}
 						if (hover) {
@@ -2250,9 +2327,19 @@ void EditView::DrawForeground(Surface *surface, const EditModel &model, const Vi
 				// Normal text display
 				if (vsDraw.styles[styleMain].visible) {
 					const Sci::string_view text(&ll->chars[ts.start], i - ts.start + 1);
+					const ShapedText *shaped = ll->ShapeSegment(surface, textFont,
+						static_cast<int>(ts.start), static_cast<int>(text.length()));
 					if (phasesDraw != PhasesDraw::One) {
-						surface->DrawTextTransparent(rcSegment, textFont,
-							ybase, text, textFore);
+						if (!surface->DrawShapedText(rcSegment, shaped, ybase, textFore)) {
+							surface->DrawTextTransparent(rcSegment, textFont,
+								ybase, text, textFore);
+						}
+					} else if (shaped) {
+						surface->FillRectangleAligned(rcSegment, Fill(textBack));
+						if (!surface->DrawShapedText(rcSegment, shaped, ybase, textFore)) {
+							surface->DrawTextTransparent(rcSegment, textFont,
+								ybase, text, textFore);
+						}
 					} else {
 						surface->DrawTextNoClip(rcSegment, textFont,
 							ybase, text, textFore, textBack);
@@ -2671,6 +2758,55 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, const V
 	}
 }
 
+// Lay out the lines being printed in parallel, remembering where they wrap, so that
+// finding page breaks does not need to lay out lines again.
+void EditView::PaginateForPrinting(const EditModel &model, Surface *surfaceMeasure, const ViewStyle &vsPrint,
+	Sci::Line lineFirst, Sci::Line lineLast, int widthPrint) {
+	const int logPixelsY = surfaceMeasure->LogPixelsY();
+	if (printPagination.Matches(model.pdoc, widthPrint, vsPrint.zoomLevel, vsPrint.wrap.state, logPixelsY) &&
+		printPagination.Contains(lineFirst) && printPagination.Contains(lineLast)) {
+		return;
+	}
+
+	const size_t linesToLayout = static_cast<size_t>(lineLast - lineFirst + 1);
+	printPagination.Reset(model.pdoc, widthPrint, vsPrint.zoomLevel, vsPrint.wrap.state, logPixelsY,
+		lineFirst, lineLast - lineFirst + 1);
+
+	size_t threads = std::min<size_t>({ linesToLayout, maxLayoutThreads });
+	if (!surfaceMeasure->SupportsFeature(Supports::ThreadSafeMeasureWidths)) {
+		threads = 1;
+	}
+	const bool multiThreaded = threads > 1;
+
+	// If only 1 thread needed then use the main thread, else spin up multiple
+	const std::launch policy = multiThreaded ? std::launch::async : std::launch::deferred;
+
+	std::atomic<size_t> nextIndex{0};
+
+	surfaceMeasure->FlushCachedState();
+	std::vector<std::future<void>> futures;
+	for (size_t th = 0; th < threads; th++) {
+		std::future<void> fut = std::async(policy,
+			[this, &model, surfaceMeasure, &vsPrint, lineFirst, linesToLayout, widthPrint, multiThreaded, &nextIndex]() {
+			LineLayout ll(-1, 200);
+			while (true) {
+				const size_t i = nextIndex.fetch_add(1, std::memory_order_acq_rel);
+				if (i >= linesToLayout) {
+					break;
+				}
+				const Sci::Line lineDoc = lineFirst + i;
+				ll.ReSet(lineDoc, model.pdoc->LineStart(lineDoc + 1) - model.pdoc->LineStart(lineDoc) + 1);
+				LayoutLine(model, surfaceMeasure, vsPrint, &ll, widthPrint, multiThreaded);
+				printPagination.SetLine(lineDoc, ll);
+			}
+		});
+		futures.push_back(std::move(fut));
+	}
+	for (const std::future<void> &f : futures) {
+		f.wait();
+	}
+}
+
 // Space (3 space characters) between line numbers and text when printing.
 #define lineNumberPrintSpace "   "
 
@@ -2763,6 +2899,11 @@ Sci::Position EditView::FormatRange(bool draw, CharacterRangeFull chrg, Rectangl
 		endPosPrint = model.pdoc->LineStart(linePrintLast + 1);
 
 	// Ensure we are styled to where we are formatting.
+	// When only measuring, lay out the whole range at once to find all its page breaks.
+	const bool paginate = !draw && (linePrintMax > linePrintLast);
+	if (paginate) {
+		endPosPrint = model.pdoc->LineStart(linePrintMax + 1);
+	}
 	model.pdoc->EnsureStyledTo(endPosPrint);
 
 	const int xStart = vsPrint.fixedColumnWidth + rc.left;
@@ -2776,6 +2917,10 @@ Sci::Position EditView::FormatRange(bool draw, CharacterRangeFull chrg, Rectangl
 	if (printParameters.wrapState == Wrap::None)
 		widthPrint = LineLayout::wrapWidthInfinite;
 
+	if (paginate) {
+		PaginateForPrinting(model, surfaceMeasure, vsPrint, linePrintStart, linePrintMax, widthPrint);
+	}
+
 	while (lineDoc <= linePrintLast && ypos < rc.bottom) {
 
 		// When printing, the hdc and hdcTarget may be the same, so
@@ -2786,8 +2931,16 @@ Sci::Position EditView::FormatRange(bool draw, CharacterRangeFull chrg, Rectangl
 
 		// Copy this line and its styles from the document into local arrays
 		// and determine the x position at which each character starts.
+		// When only measuring, page breaks are found from the wrapping found by pagination.
 		LineLayout ll(lineDoc, static_cast<int>(model.pdoc->LineStart(lineDoc + 1) - model.pdoc->LineStart(lineDoc) + 1));
-		LayoutLine(model, surfaceMeasure, vsPrint, &ll, widthPrint);
+		const bool paginated = paginate && printPagination.Contains(lineDoc);
+		if (!paginated) {
+			LayoutLine(model, surfaceMeasure, vsPrint, &ll, widthPrint);
+		}
+		const int lines = paginated ? printPagination.Lines(lineDoc) : ll.lines;
+		auto subLineStart = [&](int subLine) noexcept {
+			return paginated ? printPagination.LineStart(lineDoc, subLine) : ll.LineStart(subLine);
+		};
 
 		ll.containsCaret = false;
 
@@ -2803,14 +2956,14 @@ Sci::Position EditView::FormatRange(bool draw, CharacterRangeFull chrg, Rectangl
 		if (visibleLine == 0) {
 			const Sci::Position startWithinLine = nPrintPos -
 				model.pdoc->LineStart(lineDoc);
-			for (int iwl = 0; iwl < ll.lines - 1; iwl++) {
-				if (ll.LineStart(iwl) <= startWithinLine && ll.LineStart(iwl + 1) >= startWithinLine) {
+			for (int iwl = 0; iwl < lines - 1; iwl++) {
+				if (subLineStart(iwl) <= startWithinLine && subLineStart(iwl + 1) >= startWithinLine) {
 					visibleLine = -iwl;
 				}
 			}
 
-			if (ll.lines > 1 && startWithinLine >= ll.LineStart(ll.lines - 1)) {
-				visibleLine = -(ll.lines - 1);
+			if (lines > 1 && startWithinLine >= subLineStart(lines - 1)) {
+				visibleLine = -(lines - 1);
 			}
 		}
 
@@ -2833,7 +2986,7 @@ Sci::Position EditView::FormatRange(bool draw, CharacterRangeFull chrg, Rectangl
 		// Draw the line
 		surface->FlushCachedState();
 
-		for (int iwl = 0; iwl < ll.lines; iwl++) {
+		for (int iwl = 0; iwl < lines; iwl++) {
 			if (ypos + vsPrint.lineHeight <= rc.bottom) {
 				if (visibleLine >= 0) {
 					if (draw) {
@@ -2844,10 +2997,10 @@ Sci::Position EditView::FormatRange(bool draw, CharacterRangeFull chrg, Rectangl
 					ypos += vsPrint.lineHeight;
 				}
 				visibleLine++;
-				if (iwl == ll.lines - 1)
+				if (iwl == lines - 1)
 					nPrintPos = model.pdoc->LineStart(lineDoc + 1);
 				else
-					nPrintPos += ll.LineStart(iwl + 1) - ll.LineStart(iwl);
+					nPrintPos += subLineStart(iwl + 1) - subLineStart(iwl);
 			}
 		}
 
@@ -17,6 +17,30 @@ struct PrintParameters {
 	PrintParameters() noexcept;
 };
 
+/**
+* Sub-line starts of lines laid out for printing so paginating a document with
+* repeated FormatRange calls does not lay out each line again for each page.
+*/
+class PrintPagination {
+	const Document *pdoc = nullptr;
+	int width = 0;
+	int zoomLevel = 0;
+	Scintilla::Wrap wrapState = Scintilla::Wrap::None;
+	int logPixelsY = 0;
+	Sci::Line lineFirst = 0;
+	// Starts of the sub-lines after the first for each line from lineFirst.
+	std::vector<std::vector<int>> subLineStarts;
+public:
+	void Clear() noexcept;
+	void Reset(const Document *pdoc_, int width_, int zoomLevel_, Scintilla::Wrap wrapState_, int logPixelsY_,
+		Sci::Line lineFirst_, Sci::Line lines);
+	bool Matches(const Document *pdoc_, int width_, int zoomLevel_, Scintilla::Wrap wrapState_, int logPixelsY_) const noexcept;
+	bool Contains(Sci::Line line) const noexcept;
+	void SetLine(Sci::Line line, const LineLayout &ll);
+	int Lines(Sci::Line line) const noexcept;
+	int LineStart(Sci::Line line, int subLine) const noexcept;
+};
+
 /**
 * The view may be drawn in separate phases.
 */
@@ -45,6 +69,7 @@ typedef void (*DrawTabArrowFn)(Surface *surface, PRectangle rcTab, int ymid,
 	const ViewStyle &vsDraw, Stroke stroke);
 
 class LineTabstops;
+class LineWidths;
 
 /**
 * EditView draws the main text area.
@@ -53,6 +78,8 @@ class EditView {
 public:
 	PrintParameters printParameters;
 	std::unique_ptr<LineTabstops> ldTabstops;
+	// Width of each line when the scroll width is found from all lines
+	std::unique_ptr<LineWidths> ldWidths;
 	int tabWidthMinimumPixels;
 
 	bool drawOverstrikeCaret; // used by the curses platform
@@ -80,6 +107,7 @@ public:
 
 	LineLayoutCache llc;
 	std::unique_ptr<IPositionCache> posCache;
+	PrintPagination printPagination;
 
 	unsigned int maxLayoutThreads;
 	static constexpr int bytesPerLayoutThread = 1000;
@@ -155,6 +183,8 @@ private:
 public:
 	void PaintText(Surface *surfaceWindow, const EditModel &model, const ViewStyle &vsDraw,
 		PRectangle rcArea, PRectangle rcClient);
+	void PaginateForPrinting(const EditModel &model, Surface *surfaceMeasure, const ViewStyle &vsPrint,
+		Sci::Line lineFirst, Sci::Line lineLast, int widthPrint);
 	Sci::Position FormatRange(bool draw, CharacterRangeFull chrg, Rectangle rc, Surface *surface, Surface *surfaceMeasure,
 		const EditModel &model, const ViewStyle &vs);
 };
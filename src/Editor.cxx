@@ -122,7 +122,8 @@ static SCI_CONSTEXPR14 bool IsAllSpacesOrTabs(Sci::string_view sv) noexcept {
 	return true;
 }
 
-Editor::Editor() : durationWrapOneByte(0.000001, 0.00000001, 0.00001) {
+Editor::Editor() : durationMeasureOneByte(0.000001, 0.00000001, 0.00001),
+	durationWrapOneByte(0.000001, 0.00000001, 0.00001) {
 	ctrlID = 0;
 
 	stylesValid = false;
@@ -165,6 +166,8 @@ Editor::Editor() : durationWrapOneByte(0.000001, 0.00000001, 0.00001) {
 	xCaretMargin = 50;
 	horizontalScrollBarVisible = true;
 	scrollWidth = 2000;
+	scrollWidthExact = false;
+	lineWidthsMeasureFrom = 0;
 	verticalScrollBarVisible = true;
 	endAtLastLine = true;
 	caretSticky = CaretSticky::Off;
@@ -193,6 +196,11 @@ Editor::Editor() : durationWrapOneByte(0.000001, 0.00000001, 0.00001) {
 	idleStyling = IdleStyling::None;
 	needIdleStyling = false;
 
+	wrapThreadsUsed = 1;
+	wrapProgressNotified = false;
+
+	appendLineLimit = 0;
+
 	modEventMask = ModificationFlags::EventMaskAll;
 	commandEvents = true;
 
@@ -230,6 +238,7 @@ void Editor::InvalidateStyleData() noexcept {
 	DropGraphics();
 	view.llc.Invalidate(LineLayout::ValidLevel::invalid);
 	view.posCache->Clear();
+	view.printPagination.Clear();
 }
 
 void Editor::InvalidateStyleRedraw() {
@@ -245,6 +254,8 @@ void Editor::RefreshStyleData() {
 		if (surface) {
 			vs.Refresh(*surface, pdoc->tabInChars);
 		}
+		// Text may have changed width so measure again
+		NeedLineWidths(0, pdoc->LinesTotal());
 		SetScrollBars();
 		SetRectangularRange();
 	}
@@ -514,6 +525,43 @@ void Editor::RedrawSelMargin(Sci::Line line, bool allAfter) {
 	}
 }
 
+// The caret has moved to a line that may be in a different fold block. Fold block highlighting
+// only changes how lines inside the previously or newly highlighted block are drawn so redraw
+// the visible lines of both blocks.
+void Editor::RedrawFoldBlockHighlight(Sci::Line currentLine) {
+	const bool markersInText = vs.maskInLine || vs.maskDrawInText;
+	if (markersInText) {
+		RedrawSelMargin();
+		return;
+	}
+	const HighlightDelimiter hdOld = marginView.highlightDelimiter;
+	HighlightDelimiter hdNew;
+	hdNew.isEnabled = hdOld.isEnabled;
+	const Sci::Line lastLine = pcs->DocFromDisplay(topLine + LinesOnScreen()) + 1;
+	pdoc->GetHighlightDelimiters(hdNew, currentLine, lastLine);
+	// Update now so further caret moves within the new block do not trigger redraws
+	marginView.highlightDelimiter = hdNew;
+	if ((hdOld.beginFoldBlock == hdNew.beginFoldBlock) && (hdOld.endFoldBlock == hdNew.endFoldBlock)) {
+		return;
+	}
+	Sci::Line lineFirst = lastLine;
+	Sci::Line lineLast = -1;
+	for (const HighlightDelimiter &hd : { hdOld, hdNew }) {
+		if (hd.beginFoldBlock != -1) {
+			lineFirst = std::min(lineFirst, hd.beginFoldBlock);
+			lineLast = std::max(lineLast, hd.endFoldBlock);
+		}
+	}
+	lineFirst = std::max(lineFirst, pcs->DocFromDisplay(topLine));
+	lineLast = std::min({ lineLast, lastLine, pdoc->LinesTotal() - 1 });
+	for (Sci::Line line = lineFirst; line <= lineLast; line++) {
+		if (pcs->GetVisible(line)) {
+			// Redraws all the display lines of line
+			RedrawSelMargin(line);
+		}
+	}
+}
+
 PRectangle Editor::RectangleFromRange(Range r, int overlap) {
 	const Sci::Line minLine = pcs->DisplayFromDoc(
 		pdoc->SciLineFromPosition(r.First()));
@@ -649,7 +697,7 @@ void Editor::SetSelection(SelectionPosition currentPos_, SelectionPosition ancho
 	SetHoverIndicatorPosition(sel.MainCaret());
 
 	if (marginView.highlightDelimiter.NeedsDrawing(currentLine)) {
-		RedrawSelMargin();
+		RedrawFoldBlockHighlight(currentLine);
 	}
 	QueueIdleWork(WorkItems::updateUI);
 }
@@ -679,7 +727,7 @@ void Editor::SetSelection(SelectionPosition currentPos_) {
 	SetHoverIndicatorPosition(sel.MainCaret());
 
 	if (marginView.highlightDelimiter.NeedsDrawing(currentLine)) {
-		RedrawSelMargin();
+		RedrawFoldBlockHighlight(currentLine);
 	}
 	QueueIdleWork(WorkItems::updateUI);
 }
@@ -697,7 +745,7 @@ void Editor::SetEmptySelection(SelectionPosition currentPos_) {
 	SetHoverIndicatorPosition(sel.MainCaret());
 
 	if (marginView.highlightDelimiter.NeedsDrawing(currentLine)) {
-		RedrawSelMargin();
+		RedrawFoldBlockHighlight(currentLine);
 	}
 	QueueIdleWork(WorkItems::updateUI);
 }
@@ -844,7 +892,7 @@ void Editor::MovedCaret(SelectionPosition newPos, SelectionPosition previousPos,
 	QueueIdleWork(WorkItems::updateUI);
 
 	if (marginView.highlightDelimiter.NeedsDrawing(currentLine)) {
-		RedrawSelMargin();
+		RedrawFoldBlockHighlight(currentLine);
 	}
 }
 
@@ -1500,6 +1548,10 @@ bool Editor::WrapBlock(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToW
 	}
 
 	const bool multiThreaded = threads > 1;
+	wrapThreadsUsed = threads;
+
+	// Threads claim several lines at a time to reduce contention over nextIndex
+	const size_t linesPerClaim = Sci::clamp<size_t>(linesBeingWrapped / (threads * 16), 1, 64);
 
 	ElapsedPeriod epWrapping;
 
@@ -1528,24 +1580,27 @@ bool Editor::WrapBlock(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToW
 			// llTemporary is reused for non-significant lines, avoiding allocation costs.
 			std::shared_ptr<LineLayout> llTemporary = std::make_shared<LineLayout>(-1, 200);
 			while (true) {
-				const size_t i = nextIndex.fetch_add(1, std::memory_order_acq_rel);
-				if (i >= linesBeingWrapped) {
+				const size_t iClaim = nextIndex.fetch_add(linesPerClaim, std::memory_order_acq_rel);
+				if (iClaim >= linesBeingWrapped) {
 					break;
 				}
-				const Sci::Line lineNumber = lineToWrap + i;
-				const Range rangeLine = pdoc->LineRange(lineNumber);
-				const Sci::Position lengthLine = rangeLine.Length();
-				if (lengthLine < lengthToMultiThread) {
-					std::shared_ptr<LineLayout> ll;
-					if (significantLines.LineMayCache(lineNumber)) {
-						std::lock_guard<std::mutex> guard(mutexRetrieve);
-						ll = view.RetrieveLineLayout(lineNumber, *this);
-					} else {
-						ll = llTemporary;
-						ll->ReSet(lineNumber, lengthLine);
+				const size_t iEnd = std::min(iClaim + linesPerClaim, linesBeingWrapped);
+				for (size_t i = iClaim; i < iEnd; i++) {
+					const Sci::Line lineNumber = lineToWrap + i;
+					const Range rangeLine = pdoc->LineRange(lineNumber);
+					const Sci::Position lengthLine = rangeLine.Length();
+					if (lengthLine < lengthToMultiThread) {
+						std::shared_ptr<LineLayout> ll;
+						if (significantLines.LineMayCache(lineNumber)) {
+							std::lock_guard<std::mutex> guard(mutexRetrieve);
+							ll = view.RetrieveLineLayout(lineNumber, *this);
+						} else {
+							ll = llTemporary;
+							ll->ReSet(lineNumber, lengthLine);
+						}
+						view.LayoutLine(*this, surface, vs, ll.get(), wrapWidth, multiThreaded);
+						linesAfterWrap[i] = ll->lines;
 					}
-					view.LayoutLine(*this, surface, vs, ll.get(), wrapWidth, multiThreaded);
-					linesAfterWrap[i] = ll->lines;
 				}
 			}
 		});
@@ -1622,6 +1677,7 @@ bool Editor::WrapLines(WrapScope ws) {
 				pcs->SetHeight(lineDoc, linesWrapped);
 			}
 			wrapOccurred = true;
+			NeedLineWidths(0, pdoc->LinesTotal());
 		}
 		wrapPending.Reset();
 
@@ -1661,10 +1717,11 @@ bool Editor::WrapLines(WrapScope ws) {
 			}
 		} else if (ws == WrapScope::wsIdle) {
 			// Try to keep time taken by wrapping reasonable so interaction remains smooth.
+			// durationWrapOneByte is single threaded time so scale by the threads that share the work.
 			constexpr double secondsAllowed = 0.01;
 			const size_t actionsInAllowedTime = Sci::clamp<Sci::Line>(
-				durationWrapOneByte.ActionsInAllowedTime(secondsAllowed),
-				0x200, 0x20000);
+				durationWrapOneByte.ActionsInAllowedTime(secondsAllowed) * wrapThreadsUsed,
+				0x200, 0x20000 * wrapThreadsUsed);
 			lineToWrapEnd = pdoc->LineFromPositionAfter(lineToWrap, actionsInAllowedTime);
 		}
 		const Sci::Line lineEndNeedWrap = std::min(wrapPending.end, pdoc->LinesTotal());
@@ -1702,10 +1759,164 @@ bool Editor::WrapLines(WrapScope ws) {
 		SetTopLine(Sci::clamp<Sci::Line>(goodTopLine, 0, MaxScrollPos()));
 		SetVerticalScrollPos();
 	}
+	if (!wrapPending.NeedsWrap()) {
+		WrapProgressEnded();
+	}
 
 	return wrapOccurred;
 }
 
+// When the scroll width is exact, lines in [lineStart, lineEnd) are given an estimated width
+// immediately and are then measured during idle time.
+// Lines that were measured before keep their width until remeasured to avoid jitter.
+void Editor::NeedLineWidths(Sci::Line lineStart, Sci::Line lineEnd) {
+	if (!scrollWidthExact || Wrapping()) {
+		// Wrapped text does not scroll horizontally
+		view.ldWidths.reset();
+		return;
+	}
+	const Sci::Line linesTotal = pdoc->LinesTotal();
+	if (!view.ldWidths || (view.ldWidths->Lines() != linesTotal)) {
+		view.ldWidths = Sci::make_unique<LineWidths>();
+		view.ldWidths->InsertLines(0, linesTotal);
+		lineStart = 0;
+		lineEnd = linesTotal;
+	}
+	lineEnd = std::min(lineEnd, linesTotal);
+	const XYPOSITION aveCharWidth = vs.aveCharWidth;
+	for (Sci::Line line = lineStart; line < lineEnd; line++) {
+		if (view.ldWidths->Measured(line)) {
+			view.ldWidths->SetWidth(line, view.ldWidths->Width(line), false);
+		} else {
+			const double estimate = static_cast<double>(pdoc->LineEnd(line) - pdoc->LineStart(line)) * aveCharWidth;
+			view.ldWidths->SetWidth(line, static_cast<int>(std::min<double>(estimate, LineLayout::wrapWidthInfinite)), false);
+		}
+	}
+	lineWidthsMeasureFrom = std::min(lineWidthsMeasureFrom, lineStart);
+	if (!SetIdle(true)) {
+		// Idle processing not supported so measure everything now.
+		while (LineWidthsNeedMeasure()) {
+			const Sci::Line unmeasured = view.ldWidths->Unmeasured();
+			MeasureLineWidths();
+			if (view.ldWidths && (view.ldWidths->Unmeasured() >= unmeasured)) {
+				// No surface to measure with
+				break;
+			}
+		}
+	}
+	ScrollWidthFromLineWidths();
+}
+
+bool Editor::LineWidthsNeedMeasure() const noexcept {
+	return view.ldWidths && (view.ldWidths->Unmeasured() > 0);
+}
+
+// Measure a time-limited block of unmeasured lines in the same way as WrapBlock.
+void Editor::MeasureLineWidths() {
+	// Refresh before choosing lines as that may call NeedLineWidths and restart measuring
+	RefreshStyleData();
+	if (!LineWidthsNeedMeasure()) {
+		return;
+	}
+	const Sci::Line lineStart = view.ldWidths->NextUnmeasured(lineWidthsMeasureFrom);
+	const Sci::Line linesTotal = view.ldWidths->Lines();
+	if (lineStart >= linesTotal) {
+		return;
+	}
+	constexpr double secondsAllowed = 0.01;
+	const size_t actionsInAllowedTime = Sci::clamp<Sci::Line>(
+		durationMeasureOneByte.ActionsInAllowedTime(secondsAllowed),
+		0x200, 0x20000);
+	const Sci::Line lineEnd = Sci::clamp(pdoc->LineFromPositionAfter(lineStart, actionsInAllowedTime),
+		lineStart + 1, linesTotal);
+
+	pdoc->EnsureStyledTo(pdoc->LineStart(lineEnd));
+	RefreshStyleData();
+	AutoSurface surface(this);
+	if (!surface) {
+		return;
+	}
+
+	const size_t linesBeingMeasured = static_cast<size_t>(lineEnd - lineStart);
+	std::vector<int> widths(linesBeingMeasured);
+
+	size_t threads = std::min<size_t>({ linesBeingMeasured, view.maxLayoutThreads });
+	if (!surface->SupportsFeature(Supports::ThreadSafeMeasureWidths)) {
+		threads = 1;
+	}
+	const bool multiThreaded = threads > 1;
+
+	ElapsedPeriod epMeasuring;
+
+	// Measure all the short lines in multiple threads with temporary layouts as
+	// these lines are unlikely to be displayed soon.
+	const std::launch policy = multiThreaded ? std::launch::async : std::launch::deferred;
+	std::atomic<size_t> nextIndex{0};
+	std::vector<std::future<void>> futures;
+	for (size_t th = 0; th < threads; th++) {
+		std::future<void> fut = std::async(policy,
+			[=, &surface, &nextIndex, &widths]() {
+			LineLayout llTemporary(-1, 200);
+			while (true) {
+				const size_t i = nextIndex.fetch_add(1, std::memory_order_acq_rel);
+				if (i >= linesBeingMeasured) {
+					break;
+				}
+				const Sci::Line lineNumber = lineStart + i;
+				const Sci::Position lengthLine = pdoc->LineRange(lineNumber).Length();
+				if (lengthLine < lengthToMultiThread) {
+					llTemporary.ReSet(lineNumber, lengthLine);
+					view.LayoutLine(*this, surface, vs, &llTemporary, LineLayout::wrapWidthInfinite, multiThreaded);
+					widths[i] = static_cast<int>(llTemporary.positions[llTemporary.numCharsInLine]);
+				}
+			}
+		});
+		futures.push_back(std::move(fut));
+	}
+	for (const std::future<void> &f : futures) {
+		f.wait();
+	}
+
+	const double durationShortLinesThreads = epMeasuring.Duration(true) * threads;
+
+	// Long lines are measured in the main thread so LayoutLine may multi-thread over segments.
+	LineLayout llLarge(-1, 200);
+	for (size_t i = 0; i < linesBeingMeasured; i++) {
+		const Sci::Line lineNumber = lineStart + i;
+		const Sci::Position lengthLine = pdoc->LineRange(lineNumber).Length();
+		if (lengthLine >= lengthToMultiThread) {
+			llLarge.ReSet(lineNumber, lengthLine);
+			view.LayoutLine(*this, surface, vs, &llLarge, LineLayout::wrapWidthInfinite);
+			widths[i] = static_cast<int>(llLarge.positions[llLarge.numCharsInLine]);
+		}
+	}
+
+	const double durationLongLines = epMeasuring.Duration();
+	const size_t bytesBeingMeasured = pdoc->LineStart(lineEnd) - pdoc->LineStart(lineStart);
+	durationMeasureOneByte.AddSample(bytesBeingMeasured, durationShortLinesThreads + durationLongLines);
+
+	if (!view.ldWidths) {
+		return;
+	}
+	for (size_t i = 0; i < linesBeingMeasured; i++) {
+		view.ldWidths->SetWidth(lineStart + i, widths[i], true);
+	}
+	// Only a hint: lines needing widths again while measuring are still counted as unmeasured
+	// and NextUnmeasured continues from the start to find them
+	lineWidthsMeasureFrom = lineEnd;
+	ScrollWidthFromLineWidths();
+}
+
+void Editor::ScrollWidthFromLineWidths() {
+	if (view.ldWidths) {
+		const int widthMax = std::max(view.ldWidths->MaxWidth(), 1);
+		if (widthMax != scrollWidth) {
+			scrollWidth = widthMax;
+			SetScrollBars();
+		}
+	}
+}
+
 void Editor::LinesJoin() {
 	if (!RangeContainsProtected(targetRange.start.Position(), targetRange.end.Position())) {
 		UndoGroup ug(pdoc);
@@ -2029,6 +2240,7 @@ void Editor::InsertCharacter(Sci::string_view sv, CharacterSource charSource) {
 	if (sv.empty()) {
 		return;
 	}
+	CommitAppended();
 	FilterSelections();
 	bool wrapOccurred = false;
 	{
@@ -2215,6 +2427,38 @@ void Editor::ClearSelection(bool retainMultipleSelections) {
 	SetHoverIndicatorPosition(sel.MainCaret());
 }
 
+void Editor::AppendDeferred(const char *text, Sci::Position len) {
+	if (len <= 0)
+		return;
+	const bool wasEmpty = appendPending.empty();
+	appendPending.append(text, len);
+	// Commit when idle so that many appends in one burst become one modification.
+	// Without idle processing, commit immediately.
+	if (wasEmpty && !SetIdle(true)) {
+		CommitAppended();
+	}
+}
+
+void Editor::CommitAppended() {
+	if (appendPending.empty())
+		return;
+	std::string text;
+	text.swap(appendPending);
+	pdoc->InsertString(pdoc->Length(), text.c_str(), text.length());
+	if (appendLineLimit > 0) {
+		// Remove whole lines from the start so the document holds at most appendLineLimit lines
+		const Sci::Line linesExcess = pdoc->LinesTotal() - appendLineLimit;
+		if (linesExcess > 0) {
+			pdoc->DeleteChars(0, pdoc->LineStart(linesExcess));
+		}
+	}
+}
+
+void Editor::CommitAppendedBefore(Message iMessage) {
+	if (iMessage != Message::AppendTextDeferred)
+		CommitAppended();
+}
+
 void Editor::ClearAll() {
 	{
 		UndoGroup ug(pdoc);
@@ -2616,6 +2860,22 @@ void Editor::NotifyZoom() {
 	NotifyParent(scn);
 }
 
+void Editor::NotifyWrapProgress(Sci::Position position) {
+	NotificationData scn = {};
+	scn.nmhdr.code = Notification::WrapProgress;
+	scn.position = position;
+	scn.length = pdoc->Length();
+	NotifyParent(scn);
+}
+
+void Editor::WrapProgressEnded() {
+	// Complete reported progress whether wrapping finished or was stopped
+	if (wrapProgressNotified) {
+		wrapProgressNotified = false;
+		NotifyWrapProgress(pdoc->Length());
+	}
+}
+
 // Notifications from document
 void Editor::NotifyModifyAttempt(Document *, void *) {
 	//Platform::DebugPrintf("** Modify Attempt\n");
@@ -2630,10 +2890,17 @@ void Editor::NotifySavePoint(Document *, void *, bool atSavePoint) {
 void Editor::CheckModificationForWrap(DocModification mh) {
 	if (FlagSet(mh.modificationType, ModificationFlags::InsertText | ModificationFlags::DeleteText)) {
 		view.llc.Invalidate(LineLayout::ValidLevel::checkTextAndStyle);
+		view.printPagination.Clear();
 		const Sci::Line lineDoc = pdoc->SciLineFromPosition(mh.position);
-		const Sci::Line lines = std::max(static_cast<Sci::Line>(0), mh.linesAdded);
+		Sci::Line lines = std::max(static_cast<Sci::Line>(0), mh.linesAdded);
+		if (FlagSet(mh.modificationType, ModificationFlags::InsertText)) {
+			// A replacement that keeps lines may change several lines without adding any
+			lines = std::max(lines, pdoc->SciLineFromPosition(mh.position + mh.length) - lineDoc);
+		}
 		if (Wrapping()) {
 			NeedWrapping(lineDoc, lineDoc + lines + 1);
+		} else {
+			NeedLineWidths(lineDoc, lineDoc + lines + 1);
 		}
 		RefreshStyleData();
 		// Fix up annotation heights
@@ -2709,6 +2976,7 @@ void Editor::NotifyModified(Document *, DocModification mh, void *) {
 		}
 		if (FlagSet(mh.modificationType, ModificationFlags::ChangeStyle)) {
 			view.llc.Invalidate(LineLayout::ValidLevel::checkTextAndStyle);
+			view.printPagination.Clear();
 		}
 	} else {
 		// Move selection and brace highlights
@@ -2793,7 +3061,10 @@ void Editor::NotifyModified(Document *, DocModification mh, void *) {
 				}
 				InvalidateRange(mh.position, mh.position + mh.length);
 				if (FlagSet(changeHistoryOption, ChangeHistoryOption::Markers)) {
-					RedrawSelMargin(pdoc->SciLineFromPosition(mh.position));
+					const Sci::Line lineDoc = pdoc->SciLineFromPosition(mh.position);
+					const bool severalLines = FlagSet(mh.modificationType, ModificationFlags::InsertText) &&
+						(pdoc->SciLineFromPosition(mh.position + mh.length) > lineDoc);
+					RedrawSelMargin(lineDoc, severalLines);
 				}
 			}
 		}
@@ -3051,7 +3322,39 @@ void Editor::ChangeCaseOfSelection(CaseMapping caseMapping) {
 
 			std::string sMapped = CaseMapString(sText, caseMapping);
 
-			if (sMapped != sText) {
+			if ((sMapped.size() == sText.size()) && (sMapped != sText)) {
+				// Same length so replace only the changed spans, merging spans separated by
+				// short unchanged gaps to bound the number of modifications.
+				constexpr size_t gapMinimum = 4096;
+				const Sci::Position start = currentNoVS.Start().Position();
+				std::vector<std::pair<size_t, size_t>> spans;
+				size_t i = 0;
+				while (i < sText.size()) {
+					const size_t difference = std::mismatch(sText.begin() + i, sText.end(), sMapped.begin() + i).first - sText.begin();
+					if (difference >= sText.size())
+						break;
+					size_t endSpan = difference + 1;
+					size_t unchanged = 0;
+					while ((endSpan + unchanged < sText.size()) && (unchanged < gapMinimum)) {
+						if (sText[endSpan + unchanged] != sMapped[endSpan + unchanged]) {
+							endSpan += unchanged + 1;
+							unchanged = 0;
+						} else {
+							unchanged++;
+						}
+					}
+					spans.emplace_back(difference, endSpan);
+					i = endSpan;
+				}
+				// Replace from the end so earlier positions are unaffected
+				for (auto it = spans.rbegin(); it != spans.rend(); ++it) {
+					const Sci::Position lengthSpan = it->second - it->first;
+					pdoc->DeleteChars(start + it->first, lengthSpan);
+					pdoc->InsertString(start + it->first, sMapped.c_str() + it->first, lengthSpan);
+				}
+				// Automatic movement changes selection so reset to exactly the same as it was.
+				sel.Range(r) = current;
+			} else if (sMapped != sText) {
 				size_t firstDifference = 0;
 				while (sMapped[firstDifference] == sText[firstDifference])
 					firstDifference++;
@@ -4041,6 +4344,7 @@ int Editor::KeyDefault(Keys, KeyMod) {
 }
 
 int Editor::KeyDownWithModifiers(Keys key, KeyMod modifiers, bool *consumed) {
+	CommitAppended();
 	DwellEnd(false);
 	const Message msg = kmap.Find(key, modifiers);
 	if (msg != static_cast<Message>(0)) {
@@ -4333,7 +4637,7 @@ bool Editor::CopyLineRange(SelectionText *ss, bool allowProtected) {
 		std::string text = RangeText(start, end);
 		Sci::string_view eol = pdoc->EOLString();
 		text.append(eol.data(), eol.size());
-		ss->Copy(text, pdoc->dbcsCodePage,
+		ss->Copy(std::move(text), pdoc->dbcsCodePage,
 			vs.styles[StyleDefault].characterSet, false, true);
 		return true;
 	} else {
@@ -4359,7 +4663,7 @@ void Editor::CopySelectionRange(SelectionText *ss, bool allowLineCopy) {
 				text.append(separator.data(), separator.size());
 			}
 		}
-		ss->Copy(text, pdoc->dbcsCodePage,
+		ss->Copy(std::move(text), pdoc->dbcsCodePage,
 			vs.styles[StyleDefault].characterSet, sel.IsRectangular(), sel.selType == Selection::SelTypes::lines);
 	}
 }
@@ -4368,8 +4672,7 @@ void Editor::CopyRangeToClipboard(Sci::Position start, Sci::Position end) {
 	start = pdoc->ClampPositionIntoDocument(start);
 	end = pdoc->ClampPositionIntoDocument(end);
 	SelectionText selectedText;
-	std::string text = RangeText(start, end);
-	selectedText.Copy(text,
+	selectedText.Copy(RangeText(start, end),
 		pdoc->dbcsCodePage, vs.styles[StyleDefault].characterSet, false, false);
 	CopyToClipboard(selectedText);
 }
@@ -4665,6 +4968,7 @@ static constexpr bool AllowVirtualSpace(VirtualSpace virtualSpaceOptions, bool r
 }
 
 void Editor::ButtonDownWithModifiers(Point pt, unsigned int curTime, KeyMod modifiers) {
+	CommitAppended();
 	SetHoverIndicatorPoint(pt);
 	//Platform::DebugPrintf("ButtonDown %d %d = %d alt=%d %d\n", curTime, lastClickTime, curTime - lastClickTime, alt, inDragDrop);
 	ptMouseLast = pt;
@@ -4878,10 +5182,9 @@ void Editor::SetHoverIndicatorPosition(Sci::Position position) {
 		return;
 	if (position != Sci::invalidPosition) {
 		for (const IDecoration *deco : pdoc->decorations->View()) {
-			if (vs.indicators[deco->Indicator()].IsDynamic()) {
-				if (pdoc->decorations->ValueAt(deco->Indicator(), position)) {
-					hoverIndicatorPos = position;
-				}
+			if (vs.indicators[deco->Indicator()].IsDynamic() && deco->ValueAt(position)) {
+				hoverIndicatorPos = position;
+				break;
 			}
 		}
 	}
@@ -5139,6 +5442,8 @@ void Editor::ButtonUpWithModifiers(Point pt, unsigned int curTime, KeyMod modifi
 }
 
 bool Editor::Idle() {
+	CommitAppended();
+
 	NotifyUpdateUI();
 
 	bool needWrap = Wrapping() && wrapPending.NeedsWrap();
@@ -5148,8 +5453,16 @@ bool Editor::Idle() {
 		WrapLines(WrapScope::wsIdle);
 		// No more wrapping
 		needWrap = wrapPending.NeedsWrap();
+		// Report progress when wrapping takes more than one idle block.
+		// WrapLines reports the end of wrapping.
+		if (needWrap) {
+			wrapProgressNotified = true;
+			NotifyWrapProgress(pdoc->LineStart(std::min(wrapPending.start, pdoc->LinesTotal())));
+		}
 	} else if (needIdleStyling) {
 		IdleStyle();
+	} else if (LineWidthsNeedMeasure()) {
+		MeasureLineWidths();
 	}
 
 	// Add more idle things to do here, but make sure idleDone is
@@ -5157,7 +5470,7 @@ bool Editor::Idle() {
 	// false will stop calling this idle function until SetIdle() is
 	// called again.
 
-	const bool idleDone = !needWrap && !needIdleStyling; // && thatDone && theOtherThingDone...
+	const bool idleDone = !needWrap && !needIdleStyling && !LineWidthsNeedMeasure(); // && thatDone && theOtherThingDone...
 
 	return !idleDone;
 }
@@ -5438,6 +5751,7 @@ void Editor::SetAnnotationHeights(Sci::Line start, Sci::Line end) {
 
 void Editor::SetDocPointer(Document *document) {
 	//Platform::DebugPrintf("** %x setdoc to %x\n", pdoc, document);
+	WrapProgressEnded();
 	pdoc->RemoveWatcher(this, nullptr);
 	pdoc->Release();
 	if (!document) {
@@ -5464,12 +5778,15 @@ void Editor::SetDocPointer(Document *document) {
 	pcs->InsertLines(0, pdoc->LinesTotal() - 1);
 	SetAnnotationHeights(0, pdoc->LinesTotal());
 	view.llc.Deallocate();
+	view.printPagination.Clear();
 	NeedWrapping();
 
 	hotspot = Range(Sci::invalidPosition);
 	hoverIndicatorPos = Sci::invalidPosition;
 
 	view.ClearAllTabstops();
+	view.ldWidths.reset();
+	NeedLineWidths(0, pdoc->LinesTotal());
 
 	pdoc->AddWatcher(this, nullptr);
 	SetScrollBars();
@@ -5820,6 +6137,15 @@ Sci::Position Editor::ReplaceTarget(ReplaceType replaceType, Sci::string_view te
 		targetRange = SelectionSegment(start, SelectionPosition(range.end));
 	}
 
+	if (replaceType == ReplaceType::diff) {
+		// Only change the lines that differ so per-line state of the rest survives.
+		// Virtual space is not supported.
+		Range range(targetRange.start.Position(), targetRange.end.Position());
+		pdoc->ReplaceWithDiff(range, text);
+		targetRange = SelectionSegment(SelectionPosition(range.start), SelectionPosition(range.end));
+		return range.Length();
+	}
+
 	// Make a copy of targetRange in case callbacks use target
 	SelectionSegment replaceRange = targetRange;
 
@@ -5842,6 +6168,20 @@ Sci::Position Editor::ReplaceTarget(ReplaceType replaceType, Sci::string_view te
 	return text.length();
 }
 
+Sci::Position Editor::ReplaceAllInTarget(Sci::string_view search, Sci::string_view replacement) {
+	if (!pdoc->HasCaseFolder())
+		pdoc->SetCaseFolder(CaseFolderForEncoding());
+	Range range(targetRange.start.Position(), targetRange.end.Position());
+	try {
+		const Sci::Position replacements = pdoc->ReplaceAll(range, search.data(), search.length(), replacement, searchFlags);
+		targetRange = SelectionSegment(SelectionPosition(range.start), SelectionPosition(range.end));
+		return replacements;
+	} catch (RegexError &) {
+		errorStatus = Status::RegEx;
+		return -1;
+	}
+}
+
 bool Editor::IsUnicodeMode() const noexcept {
 	return pdoc && (CpUtf8 == pdoc->dbcsCodePage);
 }
@@ -6435,6 +6775,19 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		PLATFORM_ASSERT(lParam);
 		return ReplaceTarget(ReplaceType::minimal, ViewFromParams(lParam, wParam));
 
+	case Message::ReplaceTargetDiff:
+		PLATFORM_ASSERT(lParam);
+		return ReplaceTarget(ReplaceType::diff, ViewFromParams(lParam, wParam));
+
+	case Message::SetReplaceAllSearch:
+		PLATFORM_ASSERT(lParam);
+		replaceAllSearch.assign(ConstCharPtrFromSPtr(lParam), PositionFromUPtr(wParam));
+		break;
+
+	case Message::ReplaceAllInTarget:
+		PLATFORM_ASSERT(lParam);
+		return ReplaceAllInTarget(replaceAllSearch, ViewFromParams(lParam, wParam));
+
 	case Message::SearchInTarget:
 		PLATFORM_ASSERT(lParam);
 		return SearchInTarget(ConstCharPtrFromSPtr(lParam), PositionFromUPtr(wParam));
@@ -6604,6 +6957,17 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 			ConstCharPtrFromSPtr(lParam), PositionFromUPtr(wParam));
 		return 0;
 
+	case Message::AppendTextDeferred:
+		AppendDeferred(ConstCharPtrFromSPtr(lParam), PositionFromUPtr(wParam));
+		return 0;
+
+	case Message::SetAppendLineLimit:
+		appendLineLimit = std::max<Sci::Line>(LineFromUPtr(wParam), 0);
+		return 0;
+
+	case Message::GetAppendLineLimit:
+		return appendLineLimit;
+
 	case Message::ClearAll:
 		ClearAll();
 		return 0;
@@ -7106,6 +7470,9 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 			ContainerNeedsUpdate(Update::HScroll);
 			InvalidateStyleRedraw();
 			ReconfigureScrollBars();
+			if (!Wrapping()) {
+				WrapProgressEnded();
+			}
 		}
 		break;
 
@@ -7152,7 +7519,7 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		return static_cast<sptr_t>(vs.wrap.indentMode);
 
 	case Message::SetLayoutCache:
-		if (static_cast<LineCache>(wParam) <= LineCache::Document) {
+		if (static_cast<LineCache>(wParam) <= LineCache::Budget) {
 			view.llc.SetLevel(static_cast<LineCache>(wParam));
 		}
 		break;
@@ -7160,6 +7527,26 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetLayoutCache:
 		return static_cast<sptr_t>(view.llc.GetLevel());
 
+	case Message::SetLayoutCacheBudget:
+		view.llc.SetBudget(std::max<Sci::Position>(PositionFromUPtr(wParam), 0));
+		break;
+
+	case Message::GetLayoutCacheBudget:
+		return view.llc.GetBudget();
+
+	case Message::SetLayoutCacheCompact:
+		view.llc.SetCompact(wParam != 0);
+		break;
+
+	case Message::GetLayoutCacheCompact:
+		return view.llc.GetCompact();
+
+	case Message::GetLayoutCacheHits:
+		return view.llc.Hits();
+
+	case Message::GetLayoutCacheMisses:
+		return view.llc.Misses();
+
 	case Message::SetPositionCache:
 		view.posCache->SetSize(wParam);
 		break;
@@ -7193,6 +7580,18 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetScrollWidthTracking:
 		return trackLineWidth;
 
+	case Message::SetScrollWidthExact:
+		if (scrollWidthExact != (wParam != 0)) {
+			scrollWidthExact = wParam != 0;
+			view.ldWidths.reset();
+			lineWidthsMeasureFrom = 0;
+			NeedLineWidths(0, pdoc->LinesTotal());
+		}
+		break;
+
+	case Message::GetScrollWidthExact:
+		return scrollWidthExact;
+
 	case Message::LinesJoin:
 		LinesJoin();
 		break;
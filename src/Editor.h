@@ -79,8 +79,9 @@ public:
 		codePage = 0;
 		characterSet = Scintilla::CharacterSet::Ansi;
 	}
-	void Copy(const std::string &s_, int codePage_, Scintilla::CharacterSet characterSet_, bool rectangular_, bool lineCopy_) {
-		s = s_;
+	// Taken by value so callers can move large text in rather than copy it.
+	void Copy(std::string s_, int codePage_, Scintilla::CharacterSet characterSet_, bool rectangular_, bool lineCopy_) {
+		s = std::move(s_);
 		codePage = codePage_;
 		characterSet = characterSet_;
 		rectangular = rectangular_;
@@ -211,6 +212,9 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	int xCaretMargin;	///< Ensure this many pixels visible on both sides of caret
 	bool horizontalScrollBarVisible;
 	int scrollWidth;
+	bool scrollWidthExact;
+	Sci::Line lineWidthsMeasureFrom;
+	ActionDuration durationMeasureOneByte;
 	bool verticalScrollBarVisible;
 	bool endAtLastLine;
 	Scintilla::CaretSticky caretSticky;
@@ -250,6 +254,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	Sci::Position wordSelectInitialCaretPos;
 	SelectionSegment targetRange;
 	Scintilla::FindOption searchFlags;
+	std::string replaceAllSearch;
 	Sci::Line topLine;
 	Sci::Position posTopLine;
 	Sci::Position lengthForEncode;
@@ -265,6 +270,10 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	Scintilla::IdleStyling idleStyling;
 	bool needIdleStyling;
 
+	// Text from AppendTextDeferred waiting to be added to the document
+	std::string appendPending;
+	Sci::Line appendLineLimit;
+
 	Scintilla::ModificationFlags modEventMask;
 	bool commandEvents;
 
@@ -283,6 +292,8 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	// Wrapping support
 	WrapPending wrapPending;
 	ActionDuration durationWrapOneByte;
+	size_t wrapThreadsUsed;	///< Threads used by the last block so idle wrapping can be sized for wall time
+	bool wrapProgressNotified;
 
 	bool convertPastes;
 
@@ -332,6 +343,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	virtual void DiscardOverdraw();
 	virtual void Redraw();
 	void RedrawSelMargin(Sci::Line line=-1, bool allAfter=false);
+	void RedrawFoldBlockHighlight(Sci::Line currentLine);
 	PRectangle RectangleFromRange(Range r, int overlap);
 	void InvalidateRange(Sci::Position start, Sci::Position end);
 
@@ -404,6 +416,10 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	bool WrapBlock(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToWrapEnd);
 	enum class WrapScope {wsAll, wsVisible, wsIdle};
 	bool WrapLines(WrapScope ws);
+	void NeedLineWidths(Sci::Line lineStart, Sci::Line lineEnd);
+	bool LineWidthsNeedMeasure() const noexcept;
+	void MeasureLineWidths();
+	void ScrollWidthFromLineWidths();
 	void LinesJoin();
 	void LinesSplit(int pixelWidth);
 
@@ -433,6 +449,9 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	void InsertPasteShape(const char *text, Sci::Position len, PasteShape shape);
 	void ClearSelection(bool retainMultipleSelections = false);
 	void ClearAll();
+	void AppendDeferred(const char *text, Sci::Position len);
+	void CommitAppended();
+	void CommitAppendedBefore(Scintilla::Message iMessage);
 	void ClearDocumentStyle();
 	virtual void Cut();
 	void PasteRectangular(SelectionPosition pos, const char *ptr, Sci::Position len);
@@ -469,6 +488,8 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	void NotifyNeedShown(Sci::Position pos, Sci::Position len);
 	void NotifyDwelling(Point pt, bool state);
 	void NotifyZoom();
+	void NotifyWrapProgress(Sci::Position position);
+	void WrapProgressEnded();
 
 	void NotifyModifyAttempt(Document *document, void *userData) override;
 	void NotifySavePoint(Document *document, void *userData, bool atSavePoint) override;
@@ -594,8 +615,9 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	void FoldAll(Scintilla::FoldAction action);
 
 	Sci::Position GetTag(char *tagValue, int tagNumber);
-	enum class ReplaceType {basic, patterns, minimal};
+	enum class ReplaceType {basic, patterns, minimal, diff};
 	Sci::Position ReplaceTarget(ReplaceType replaceType, Sci::string_view text);
+	Sci::Position ReplaceAllInTarget(Sci::string_view search, Sci::string_view replacement);
 
 	bool PositionIsHotspot(Sci::Position position) const noexcept;
 	bool PointIsHotspot(Point pt);
@@ -349,7 +349,7 @@ void LineMarker::Draw(Surface *surface, const PRectangle &rcWhole, const Font *f
 		rcImage.bottom = rcImage.top + image->GetScaledHeight();
 		rcImage.left = ((rcWhole.left + rcWhole.right) - image->GetScaledWidth()) / 2;
 		rcImage.right = rcImage.left + image->GetScaledWidth();
-		surface->DrawRGBAImage(rcImage, image->GetWidth(), image->GetHeight(), image->Pixels());
+		image->Draw(surface, rcImage);
 		return;
 	}
 
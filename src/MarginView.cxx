@@ -257,6 +257,23 @@ LineMarker::FoldPart PartForFoldHighlight(const HighlightDelimiter &highlightDel
 	return LineMarker::FoldPart::undefined;
 }
 
+// Format number in decimal at the end of buffer without allocating.
+Sci::string_view FormatLineNumber(Sci::Line number, char *buffer, size_t size) noexcept {
+	char *end = buffer + size;
+	char *start = end;
+	do {
+		*--start = static_cast<char>('0' + number % 10);
+		number /= 10;
+	} while ((number > 0) && (start > buffer));
+	return Sci::string_view(start, end - start);
+}
+
+bool AllDigits(Sci::string_view text) noexcept {
+	return std::all_of(text.begin(), text.end(), [](char ch) noexcept {
+		return ch >= '0' && ch <= '9';
+	});
+}
+
 SCI_CONSTEXPR14 LineMarker::FoldPart PartForBar(bool markBefore, bool markAfter) {
 	if (markBefore) {
 		if (markAfter) {
@@ -367,10 +384,12 @@ void MarginView::PaintOneMargin(Surface *surface, PRectangle rc, PRectangle rcOn
 			yposScreen + vs.lineHeight);
 		if (marginStyle.style == MarginType::Number) {
 			if (firstSubLine) {
-				std::string sNumber;
+				char digits[30];
+				Sci::string_view sNumber;
 				if (lineDoc >= 0) {
-					sNumber = std::to_string(lineDoc + 1);
+					sNumber = FormatLineNumber(lineDoc + 1, digits, sizeof(digits));
 				}
+				std::string sFoldDebug;
 				if (FlagSet(model.foldFlags, (FoldFlag::LevelNumbers | FoldFlag::LineState))) {
 					char number[100] = "";
 					if (FlagSet(model.foldFlags, FoldFlag::LevelNumbers)) {
@@ -385,11 +404,12 @@ void MarginView::PaintOneMargin(Surface *surface, PRectangle rc, PRectangle rcOn
 						const int state = model.pdoc->GetLineState(lineDoc);
 						snprintf(number, Sci::size(number), "%0X", state);
 					}
-					sNumber = number;
+					sFoldDebug = number;
+					sNumber = sFoldDebug;
 				}
 				PRectangle rcNumber = rcMarker;
 				// Right justify
-				const XYPOSITION width = surface->WidthText(vs.styles[StyleLineNumber].font.get(), sNumber);
+				const XYPOSITION width = WidthNumber(surface, vs, sNumber);
 				const XYPOSITION xpos = rcNumber.right - width - vs.marginNumberPadding;
 				rcNumber.left = xpos;
 				DrawTextNoClipPhase(surface, rcNumber, vs.styles[StyleLineNumber],
@@ -460,6 +480,24 @@ void MarginView::PaintOneMargin(Surface *surface, PRectangle rc, PRectangle rcOn
 	}
 }
 
+// Line numbers are measured from the ASCII advances found when the font was realised.
+XYPOSITION MarginView::WidthNumber(Surface *surface, const ViewStyle &vs, Sci::string_view number) const {
+	const Style &style = vs.styles[StyleLineNumber];
+	if (AllDigits(number)) {
+		if (style.monospaceASCII) {
+			return style.monospaceCharacterWidth * number.length();
+		} else if (style.asciiAdvances) {
+			const std::vector<XYPOSITION> &advances = *style.asciiAdvances;
+			XYPOSITION width = 0.0;
+			for (const char ch : number) {
+				width += advances[static_cast<unsigned char>(ch)];
+			}
+			return width;
+		}
+	}
+	return surface->WidthText(style.font.get(), number);
+}
+
 void MarginView::PaintMargin(Surface *surface, Sci::Line topLine, PRectangle rc, PRectangle rcMargin,
 	const EditModel &model, const ViewStyle &vs) {
 
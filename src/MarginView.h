@@ -36,6 +36,7 @@ public:
 
 	void DropGraphics() noexcept;
 	void RefreshPixMaps(Surface *surfaceWindow, const ViewStyle &vsDraw);
+	XYPOSITION WidthNumber(Surface *surface, const ViewStyle &vs, Sci::string_view number) const;
 	void PaintOneMargin(Surface *surface, PRectangle rc, PRectangle rcOneMargin, const MarginStyle &marginStyle,
 		const EditModel &model, const ViewStyle &vs) const;
 	void PaintMargin(Surface *surface, Sci::Line topLine, PRectangle rc, PRectangle rcMargin,
@@ -549,3 +549,112 @@ int LineTabstops::GetNextTabstop(Sci::Line line, int x) const noexcept {
 	}
 	return 0;
 }
+
+namespace {
+
+constexpr int EncodeWidth(int width, bool measured) noexcept {
+	return measured ? width : -1 - width;
+}
+
+constexpr int DecodeWidth(int value) noexcept {
+	return (value >= 0) ? value : -1 - value;
+}
+
+}
+
+void LineWidths::Replacing(int valueOld, int widthNew) noexcept {
+	const int widthOld = DecodeWidth(valueOld);
+	if ((widthOld >= widthMax) && (widthOld > widthNew)) {
+		// Widest line narrowed
+		maxValid = false;
+	}
+}
+
+void LineWidths::Init() {
+	widths.DeleteAll();
+	unmeasured = 0;
+	widthMax = 0;
+	maxValid = true;
+}
+
+void LineWidths::InsertLine(Sci::Line line) {
+	widths.EnsureLength(line);
+	widths.Insert(line, EncodeWidth(0, false));
+	unmeasured++;
+}
+
+void LineWidths::InsertLines(Sci::Line line, Sci::Line lines) {
+	widths.EnsureLength(line);
+	widths.InsertValue(line, lines, EncodeWidth(0, false));
+	unmeasured += lines;
+}
+
+void LineWidths::RemoveLine(Sci::Line line) {
+	if (widths.Length() > line) {
+		const int valueOld = widths.ValueAt(line);
+		Replacing(valueOld, 0);
+		if (valueOld < 0)
+			unmeasured--;
+		widths.Delete(line);
+	}
+}
+
+Sci::Line LineWidths::Lines() const noexcept {
+	return widths.Length();
+}
+
+void LineWidths::SetWidth(Sci::Line line, int width, bool measured) {
+	widths.EnsureLength(line + 1);
+	const int valueOld = widths.ValueAt(line);
+	Replacing(valueOld, width);
+	if ((valueOld < 0) && measured)
+		unmeasured--;
+	else if ((valueOld >= 0) && !measured)
+		unmeasured++;
+	widths.SetValueAt(line, EncodeWidth(width, measured));
+	if (maxValid && (width > widthMax)) {
+		widthMax = width;
+	}
+}
+
+int LineWidths::Width(Sci::Line line) const noexcept {
+	return DecodeWidth(widths.ValueAt(line));
+}
+
+bool LineWidths::Measured(Sci::Line line) const noexcept {
+	return (line < widths.Length()) && (widths.ValueAt(line) >= 0);
+}
+
+Sci::Line LineWidths::Unmeasured() const noexcept {
+	return unmeasured;
+}
+
+// Return the first line at or after line that has not been measured, continuing from the
+// start if there are none after line, or Lines() if all have been measured.
+Sci::Line LineWidths::NextUnmeasured(Sci::Line line) const noexcept {
+	const Sci::Line lines = widths.Length();
+	if (unmeasured == 0) {
+		return lines;
+	}
+	for (Sci::Line searched = 0; searched < lines; searched++) {
+		if (line >= lines) {
+			line = 0;
+		}
+		if (widths.ValueAt(line) < 0) {
+			return line;
+		}
+		line++;
+	}
+	return lines;
+}
+
+int LineWidths::MaxWidth() noexcept {
+	if (!maxValid) {
+		widthMax = 0;
+		for (Sci::Line line = 0; line < widths.Length(); line++) {
+			widthMax = std::max(widthMax, DecodeWidth(widths.ValueAt(line)));
+		}
+		maxValid = true;
+	}
+	return widthMax;
+}
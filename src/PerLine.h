@@ -135,6 +135,37 @@ public:
 	int GetNextTabstop(Sci::Line line, int x) const noexcept;
 };
 
+/**
+ * The width in pixels of each line so the horizontal scroll bar can cover the widest line.
+ * Widths are estimated until measured. The maximum is kept up to date as widths change and
+ * is only found again by examining every line after the widest line narrows or is removed.
+ * The number of unmeasured lines is counted so finding there is nothing left to measure is
+ * immediate and a search for the next unmeasured line stops once it has found them all.
+ */
+class LineWidths : public PerLine {
+	// Measured widths are stored as themselves and estimated widths as -1 - width
+	SplitVector<int> widths;
+	Sci::Line unmeasured;
+	int widthMax;
+	bool maxValid;
+	void Replacing(int valueOld, int widthNew) noexcept;
+public:
+	LineWidths() : unmeasured(0), widthMax(0), maxValid(true) {
+	}
+	void Init() override;
+	void InsertLine(Sci::Line line) override;
+	void InsertLines(Sci::Line line, Sci::Line lines) override;
+	void RemoveLine(Sci::Line line) override;
+
+	Sci::Line Lines() const noexcept;
+	void SetWidth(Sci::Line line, int width, bool measured);
+	int Width(Sci::Line line) const noexcept;
+	bool Measured(Sci::Line line) const noexcept;
+	Sci::Line Unmeasured() const noexcept;
+	Sci::Line NextUnmeasured(Sci::Line line) const noexcept;
+	int MaxWidth() noexcept;
+};
+
 }}
 
 #endif
@@ -183,6 +183,45 @@ struct SurfaceMode {
 	}
 };
 
+/**
+ * An image converted by a Surface into its platform's drawing format so it can be
+ * drawn repeatedly without conversion.
+ */
+class ImageHandle {
+public:
+	ImageHandle() noexcept = default;
+	// Deleted so ImageHandle objects can not be copied.
+	ImageHandle(const ImageHandle &) = delete;
+	ImageHandle(ImageHandle &&) = delete;
+	ImageHandle &operator=(const ImageHandle &) = delete;
+	ImageHandle &operator=(ImageHandle &&) = delete;
+	virtual ~ImageHandle() noexcept = default;
+};
+
+/**
+ * Text shaped by a Surface into positioned glyphs so it can be drawn repeatedly
+ * without shaping again.
+ */
+class ShapedText {
+public:
+	ShapedText() noexcept = default;
+	// Deleted so ShapedText objects can not be copied.
+	ShapedText(const ShapedText &) = delete;
+	ShapedText(ShapedText &&) = delete;
+	ShapedText &operator=(const ShapedText &) = delete;
+	ShapedText &operator=(ShapedText &&) = delete;
+	virtual ~ShapedText() noexcept = default;
+};
+
+/**
+ * A run of UTF-8 text in a single font to be measured as part of a batch.
+ */
+struct TextMeasureRequest {
+	const Font *font;
+	Sci::string_view text;
+	XYPOSITION *positions;
+};
+
 /**
  * A surface abstracts a place to draw.
  */
@@ -229,6 +268,14 @@ public:
 	enum class GradientOptions { leftToRight, topToBottom };
 	virtual void GradientRectangle(PRectangle rc, const std::vector<ColourStop> &stops, GradientOptions options)=0;
 	virtual void DrawRGBAImage(PRectangle rc, int width, int height, const unsigned char *pixelsImage) = 0;
+	// Image handles are optional: surfaces that do not support them return nullptr from
+	// CreateImageHandle and false from DrawImageHandle so callers use DrawRGBAImage.
+	virtual std::shared_ptr<ImageHandle> CreateImageHandle(int /* width */, int /* height */, const unsigned char * /* pixelsImage */) {
+		return nullptr;
+	}
+	virtual bool DrawImageHandle(PRectangle /* rc */, ImageHandle * /* handle */) {
+		return false;
+	}
 	virtual void Ellipse(PRectangle rc, FillStroke fillStroke)=0;
 	virtual void Stadium(PRectangle rc, FillStroke fillStroke, Ends ends)=0;
 	virtual void Copy(PRectangle rc, Point from, Surface &surfaceSource)=0;
@@ -238,6 +285,15 @@ public:
 	virtual void DrawTextNoClip(PRectangle rc, const Font *font_, XYPOSITION ybase, Sci::string_view text, ColourRGBA fore, ColourRGBA back) = 0;
 	virtual void DrawTextClipped(PRectangle rc, const Font *font_, XYPOSITION ybase, Sci::string_view text, ColourRGBA fore, ColourRGBA back) = 0;
 	virtual void DrawTextTransparent(PRectangle rc, const Font *font_, XYPOSITION ybase, Sci::string_view text, ColourRGBA fore) = 0;
+	// Shaped text is optional: surfaces that support it declare Supports::ShapedText.
+	// Others return nullptr from ShapeText and false from DrawShapedText so callers use DrawTextTransparent.
+	// Text is in the surface's encoding as for DrawTextTransparent.
+	virtual std::shared_ptr<ShapedText> ShapeText(const Font * /* font_ */, Sci::string_view /* text */) {
+		return nullptr;
+	}
+	virtual bool DrawShapedText(PRectangle /* rc */, const ShapedText * /* shaped */, XYPOSITION /* ybase */, ColourRGBA /* fore */) {
+		return false;
+	}
 	virtual void MeasureWidths(const Font *font_, Sci::string_view text, XYPOSITION *positions) = 0;
 	virtual XYPOSITION WidthText(const Font *font_, Sci::string_view text) = 0;
 
@@ -246,6 +302,12 @@ public:
 	virtual void DrawTextTransparentUTF8(PRectangle rc, const Font *font_, XYPOSITION ybase, Sci::string_view text, ColourRGBA fore) = 0;
 	virtual void MeasureWidthsUTF8(const Font *font_, Sci::string_view text, XYPOSITION *positions) = 0;
 	virtual XYPOSITION WidthTextUTF8(const Font *font_, Sci::string_view text) = 0;
+	// Measure several independent runs. Platforms may shape them together to reduce overhead.
+	virtual void MeasureWidthsBatchUTF8(const TextMeasureRequest *requests, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			MeasureWidthsUTF8(requests[i].font, requests[i].text, requests[i].positions);
+		}
+	}
 
 	virtual XYPOSITION Ascent(const Font *font_)=0;
 	virtual XYPOSITION Descent(const Font *font_)=0;
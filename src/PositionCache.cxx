@@ -16,6 +16,8 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <list>
+#include <unordered_map>
 #include <algorithm>
 #include <iterator>
 #include <memory>
@@ -74,9 +76,12 @@ LineLayout::LineLayout(Sci::Line lineNumber_, int maxLineLength_) :
 	containsCaret(false),
 	edgeColumn(0),
 	bracePreviousStyles{},
+	indicatorRunsLine(-1),
+	indicatorRunsVersion(0),
 	widthLine(wrapWidthInfinite),
 	lines(1),
-	wrapIndent(0) {
+	wrapIndent(0),
+	generation(0) {
 	Resize(maxLineLength_);
 }
 
@@ -122,15 +127,32 @@ void LineLayout::Free() noexcept {
 	lineStarts.reset();
 	lenLineStarts = 0;
 	bidiData.reset();
+	compact.reset();
+	ClearShapedText();
+	ClearIndicatorRuns();
 }
 
 void LineLayout::ClearPositions() {
 	std::fill(&positions[0], &positions[maxLineLength + 2], 0.0f);
 }
 
+void LineLayout::ClearShapedText() noexcept {
+	shapedSegments.clear();
+}
+
+void LineLayout::ClearIndicatorRuns() noexcept {
+	indicatorRuns.clear();
+	indicatorRunsLine = -1;
+}
+
 void LineLayout::Invalidate(ValidLevel validity_) noexcept {
 	if (validity > validity_)
 		validity = validity_;
+	if (validity_ == ValidLevel::invalid) {
+		ClearShapedText();
+		// Text changes move indicators without changing the decorations version
+		ClearIndicatorRuns();
+	}
 }
 
 Sci::Line LineLayout::LineNumber() const noexcept {
@@ -141,6 +163,89 @@ bool LineLayout::CanHold(Sci::Line lineDoc, int lineLength_) const noexcept {
 	return (lineNumber == lineDoc) && (lineLength_ <= maxLineLength);
 }
 
+// Replace the per byte arrays with a CompactLayout holding only what is needed to restore them.
+// Only called for layouts not used outside the cache since the arrays are released.
+void LineLayout::Compact() {
+	if (compact || bidiData) {
+		return;
+	}
+	std::unique_ptr<CompactLayout> compacted = Sci::make_unique<CompactLayout>();
+	if (validity != ValidLevel::invalid) {
+		// Elements up to and including numCharsInLine are valid
+		const size_t length = numCharsInLine + 1;
+		compacted->chars.assign(chars.get(), chars.get() + length);
+		compacted->styles.assign(styles.get(), styles.get() + length);
+		compacted->repeats.resize(length);
+		XYPOSITION xPrevious = 0;
+		for (size_t i = 0; i < length; i++) {
+			if (positions[i] == xPrevious) {
+				compacted->repeats[i] = true;
+			} else {
+				compacted->positions.push_back(static_cast<float>(positions[i]));
+				xPrevious = positions[i];
+			}
+		}
+		compacted->positions.shrink_to_fit();
+	}
+	compact = std::move(compacted);
+	chars.reset();
+	styles.reset();
+	positions.reset();
+	ClearShapedText();
+	ClearIndicatorRuns();
+}
+
+void LineLayout::Expand() {
+	if (!compact) {
+		return;
+	}
+	const size_t lineAllocation = maxLineLength + 1;
+	chars = Sci::make_unique<char[]>(lineAllocation);
+	styles = Sci::make_unique<unsigned char []>(lineAllocation);
+	positions = Sci::make_unique<XYPOSITION []>(lineAllocation + 1);
+	ClearPositions();
+	std::copy(compact->chars.cbegin(), compact->chars.cend(), chars.get());
+	std::copy(compact->styles.cbegin(), compact->styles.cend(), styles.get());
+	XYPOSITION x = 0;
+	size_t stored = 0;
+	for (size_t i = 0; i < compact->repeats.size(); i++) {
+		if (!compact->repeats[i]) {
+			x = compact->positions[stored++];
+		}
+		positions[i] = x;
+	}
+	compact.reset();
+}
+
+// Approximate number of bytes allocated for this layout
+size_t LineLayout::MemoryUsage() const noexcept {
+	// Shaped text is held by the platform so assume a glyph and an advance for each byte
+	size_t bytes = shapedSegments.capacity() * sizeof(ShapedSegment);
+	for (const ShapedSegment &segment : shapedSegments) {
+		bytes += segment.length * (sizeof(int) + sizeof(XYPOSITION));
+	}
+	bytes += indicatorRuns.capacity() * sizeof(IndicatorRuns);
+	for (const IndicatorRuns &indicatorRun : indicatorRuns) {
+		bytes += indicatorRun.runs.capacity() * sizeof(IndicatorRun);
+	}
+	if (compact) {
+		return bytes + sizeof(LineLayout) + sizeof(CompactLayout) +
+			compact->chars.capacity() + compact->styles.capacity() +
+			compact->positions.capacity() * sizeof(float) +
+			compact->repeats.capacity() / 8 +
+			lenLineStarts * sizeof(int);
+	}
+	const size_t lineAllocation = maxLineLength + 1;
+	bytes += sizeof(LineLayout) +
+		lineAllocation * (sizeof(char) + sizeof(unsigned char)) +
+		(lineAllocation + 1) * sizeof(XYPOSITION) +
+		lenLineStarts * sizeof(int);
+	if (bidiData) {
+		bytes += lineAllocation * (sizeof(std::shared_ptr<Font>) + sizeof(XYPOSITION));
+	}
+	return bytes;
+}
+
 int LineLayout::LineStart(int line) const noexcept {
 	if (line <= 0) {
 		return 0;
@@ -334,6 +439,69 @@ int LineLayout::EndLineStyle() const noexcept {
 	return styles[numCharsBeforeEOL > 0 ? numCharsBeforeEOL-1 : 0];
 }
 
+const ShapedText *LineLayout::ShapeSegment(Surface *surface, const Font *font, int start, int length) const {
+	if (!surface->SupportsFeature(Supports::ShapedText)) {
+		return nullptr;
+	}
+	// Selection and indicator changes split lines into different segments so bound the
+	// number of remembered segments.
+	constexpr size_t maxShapedSegments = 100;
+	for (const ShapedSegment &segment : shapedSegments) {
+		if ((segment.start == start) && (segment.length == length) && (segment.font == font)) {
+			return segment.shaped.get();
+		}
+	}
+	if (shapedSegments.size() >= maxShapedSegments) {
+		shapedSegments.clear();
+	}
+	// Remember failures too so unsupported text is not shaped on each paint.
+	std::shared_ptr<ShapedText> shaped = surface->ShapeText(font, Sci::string_view(&chars[start], length));
+	shapedSegments.push_back({ start, length, font, std::move(shaped) });
+	return shapedSegments.back().shaped.get();
+}
+
+const LineLayout::IndicatorRun *LineLayout::IndicatorRuns::RunContaining(Sci::Position position) const noexcept {
+	// Runs are in order and don't overlap so find the first ending after position
+	const std::vector<IndicatorRun>::const_iterator it = std::upper_bound(runs.begin(), runs.end(), position,
+		[](Sci::Position pos, const IndicatorRun &run) noexcept {
+		return pos < run.end;
+	});
+	if ((it != runs.end()) && (it->start <= position))
+		return &*it;
+	return nullptr;
+}
+
+const std::vector<LineLayout::IndicatorRuns> &LineLayout::Indicators(const Document *pdoc, Sci::Position posLineStart) const {
+	const unsigned int version = pdoc->decorations->Version();
+	if ((indicatorRunsLine == lineNumber) && (indicatorRunsVersion == version)) {
+		return indicatorRuns;
+	}
+	indicatorRuns.clear();
+	const Sci::Position posLineEnd = posLineStart + numCharsInLine;
+	for (const IDecoration *deco : pdoc->decorations->View()) {
+		IndicatorRuns runsOfIndicator{ deco->Indicator(), {} };
+		Sci::Position position = posLineStart;
+		do {
+			const Sci::Position startRun = deco->StartRun(position);
+			const Sci::Position endRun = deco->EndRun(position);
+			const int value = deco->ValueAt(position);
+			if (value) {
+				runsOfIndicator.runs.push_back({ startRun - posLineStart, endRun - posLineStart, value });
+			}
+			if (endRun <= position) {
+				break;
+			}
+			position = endRun;
+		} while (position < posLineEnd);
+		if (!runsOfIndicator.runs.empty()) {
+			indicatorRuns.push_back(std::move(runsOfIndicator));
+		}
+	}
+	indicatorRunsLine = lineNumber;
+	indicatorRunsVersion = version;
+	return indicatorRuns;
+}
+
 void LineLayout::WrapLine(const Document *pdoc, Sci::Position posLineStart, Wrap wrapState, XYPOSITION wrapWidth) {
 	// Document wants document positions but simpler to work in line positions
 	// so take care of adding and subtracting line start in a lambda.
@@ -463,14 +631,94 @@ bool SignificantLines::LineMayCache(Sci::Line line) const noexcept {
 		return (std::abs(line - lineCaret) < linesOnScreen) ||
 			((line >= lineTop) && (line <= (lineTop + linesOnScreen)));
 	case LineCache::Document:
+	case LineCache::Budget:
 	default:
 		return true;
 	}
 }
 
+namespace Scintilla { namespace Internal {
+
+// Layouts in order of use with a hash from line number to entry so both retrieval and
+// eviction of the least recently used layout are constant time.
+// Recently used layouts are hot and the rest cold where they may be compacted.
+class LineLayoutBudget {
+	struct Entry {
+		std::shared_ptr<LineLayout> ll;
+		size_t bytes;
+		bool hot;
+	};
+	using Entries = std::list<Entry>;
+	// Most recently used at front of each list
+	Entries hot;
+	Entries cold;
+	std::unordered_map<Sci::Line, Entries::iterator> entryFromLine;
+	size_t bytesUsed = 0;
+	void Remove(Entries::iterator it) noexcept {
+		bytesUsed -= it->bytes;
+		entryFromLine.erase(it->ll->LineNumber());
+		(it->hot ? hot : cold).erase(it);
+	}
+	void Measure(Entry &entry) noexcept {
+		const size_t bytes = entry.ll->MemoryUsage();
+		bytesUsed += bytes - entry.bytes;
+		entry.bytes = bytes;
+	}
+public:
+	std::shared_ptr<LineLayout> Find(Sci::Line lineNumber, int maxChars) {
+		const auto found = entryFromLine.find(lineNumber);
+		if (found == entryFromLine.end()) {
+			return {};
+		}
+		const Entries::iterator it = found->second;
+		if (!it->ll->CanHold(lineNumber, maxChars)) {
+			Remove(it);
+			return {};
+		}
+		hot.splice(hot.begin(), it->hot ? hot : cold, it);
+		it->hot = true;
+		it->ll->Expand();
+		// Layout may have changed size since measured, for example by wrapping
+		Measure(*it);
+		return it->ll;
+	}
+	void Add(const std::shared_ptr<LineLayout> &ll) {
+		hot.push_front({ll, ll->MemoryUsage(), true});
+		entryFromLine[ll->LineNumber()] = hot.begin();
+		bytesUsed += hot.front().bytes;
+	}
+	void Cool(size_t hotMaximum, bool compact) {
+		while (hot.size() > hotMaximum) {
+			const Entries::iterator it = std::prev(hot.end());
+			cold.splice(cold.begin(), hot, it);
+			it->hot = false;
+			// Layouts still referenced outside the cache may be in use so can not be compacted
+			if (compact && (it->ll.use_count() == 1)) {
+				it->ll->Compact();
+			}
+			// Drawing may have cached shaped text and indicator runs since it was measured
+			Measure(*it);
+		}
+	}
+	void Evict(size_t bytesBudget) noexcept {
+		while ((bytesUsed > bytesBudget) && !cold.empty()) {
+			Remove(std::prev(cold.end()));
+		}
+		// Always retain the most recently used layout
+		while ((bytesUsed > bytesBudget) && (hot.size() > 1)) {
+			Remove(std::prev(hot.end()));
+		}
+	}
+};
+
+}}
+
 LineLayoutCache::LineLayoutCache() :
 	level(LineCache::None),
-	maxValidity(LineLayout::ValidLevel::invalid), styleClock(-1) {
+	bytesBudget(bytesBudgetDefault), compactLayouts(false), hits(0), misses(0),
+	maxValidity(LineLayout::ValidLevel::invalid),
+	generation(0), generationInvalidated{},
+	styleClock(-1) {
 }
 
 LineLayoutCache::~LineLayoutCache() = default;
@@ -483,6 +731,13 @@ constexpr size_t AlignUp(size_t value, size_t alignment) noexcept {
 
 constexpr size_t alignmentLLC = 20;
 
+// Define VERIFY_ASCII_ADVANCES to check measurement from font advance tables against the platform.
+#ifdef VERIFY_ASCII_ADVANCES
+constexpr bool verifyASCIIAdvances = true;
+#else
+constexpr bool verifyASCIIAdvances = false;
+#endif
+
 constexpr bool GraphicASCII(char ch) noexcept {
 	return ch >= ' ' && ch <= '~';
 }
@@ -504,6 +759,8 @@ size_t LineLayoutCache::EntryForLine(Sci::Line line) const noexcept {
 		return 1 + (line % (cache.size() - 1));
 	case LineCache::Document:
 		return line;
+	case LineCache::Budget:
+		return 0;
 	}
 	return 0;
 }
@@ -564,16 +821,47 @@ void LineLayoutCache::AllocateForLevel(Sci::Line linesOnScreen, Sci::Line linesI
 void LineLayoutCache::Deallocate() noexcept {
 	maxValidity = LineLayout::ValidLevel::invalid;
 	cache.clear();
+	budget.reset();
 }
 
 void LineLayoutCache::Invalidate(LineLayout::ValidLevel validity_) noexcept {
+	// Constant time: layouts check for invalidations when retrieved
 	if (maxValidity > validity_) {
 		maxValidity = validity_;
-		for (const std::shared_ptr<LineLayout> &ll : cache) {
-			if (ll) {
-				ll->Invalidate(validity_);
+		generation++;
+		generationInvalidated[static_cast<size_t>(validity_)] = generation;
+	}
+}
+
+void LineLayoutCache::ApplyInvalidations(LineLayout &ll) const noexcept {
+	if (ll.generation != generation) {
+		// The lowest level invalidated since the layout was last retrieved includes any higher levels
+		for (size_t validLevel = 0; validLevel < validLevels; validLevel++) {
+			if (generationInvalidated[validLevel] > ll.generation) {
+				ll.Invalidate(static_cast<LineLayout::ValidLevel>(validLevel));
+				break;
 			}
 		}
+		ll.generation = generation;
+	}
+}
+
+void LineLayoutCache::CountRetrieval(const LineLayout &ll) noexcept {
+	// A layout whose positions were invalidated has to be laid out again so is not a hit.
+	// One that only needs its text and style checked is counted by CountChecked once
+	// LayoutLine has decided whether it can be reused.
+	if (ll.validity >= LineLayout::ValidLevel::positions) {
+		hits++;
+	} else if (ll.validity == LineLayout::ValidLevel::invalid) {
+		misses++;
+	}
+}
+
+void LineLayoutCache::CountChecked(bool reused) noexcept {
+	if (reused) {
+		hits++;
+	} else {
+		misses++;
 	}
 }
 
@@ -582,9 +870,39 @@ void LineLayoutCache::SetLevel(LineCache level_) noexcept {
 		level = level_;
 		maxValidity = LineLayout::ValidLevel::invalid;
 		cache.clear();
+		budget.reset();
+		hits = 0;
+		misses = 0;
 	}
 }
 
+void LineLayoutCache::SetBudget(size_t bytesBudget_) {
+	bytesBudget = bytesBudget_;
+	if (budget) {
+		budget->Evict(bytesBudget);
+	}
+}
+
+std::shared_ptr<LineLayout> LineLayoutCache::RetrieveBudgeted(Sci::Line lineNumber, int maxChars, Sci::Line linesOnScreen) {
+	if (!budget) {
+		budget = Sci::make_unique<LineLayoutBudget>();
+	}
+	std::shared_ptr<LineLayout> ll = budget->Find(lineNumber, maxChars);
+	if (ll) {
+		ApplyInvalidations(*ll);
+		CountRetrieval(*ll);
+	} else {
+		misses++;
+		ll = std::make_shared<LineLayout>(lineNumber, maxChars);
+		ll->generation = generation;
+		budget->Add(ll);
+	}
+	// Keep a screen either side of the current view ready for use
+	budget->Cool(linesOnScreen * 3, compactLayouts);
+	budget->Evict(bytesBudget);
+	return ll;
+}
+
 std::shared_ptr<LineLayout> LineLayoutCache::Retrieve(Sci::Line lineNumber, Sci::Line lineCaret, int maxChars, int styleClock_,
                                       Sci::Line linesOnScreen, Sci::Line linesInDoc) {
 	AllocateForLevel(linesOnScreen, linesInDoc);
@@ -593,6 +911,9 @@ std::shared_ptr<LineLayout> LineLayoutCache::Retrieve(Sci::Line lineNumber, Sci:
 		styleClock = styleClock_;
 	}
 	maxValidity = LineLayout::ValidLevel::lines;
+	if (level == LineCache::Budget) {
+		return RetrieveBudgeted(lineNumber, maxChars, linesOnScreen);
+	}
 	size_t pos = 0;
 	if (level == LineCache::Page) {
 		// If first entry is this line then just reuse it.
@@ -626,8 +947,13 @@ std::shared_ptr<LineLayout> LineLayoutCache::Retrieve(Sci::Line lineNumber, Sci:
 		if (cache[pos] && !cache[pos]->CanHold(lineNumber, maxChars)) {
 			cache[pos].reset();
 		}
-		if (!cache[pos]) {
+		if (cache[pos]) {
+			ApplyInvalidations(*cache[pos]);
+			CountRetrieval(*cache[pos]);
+		} else {
+			misses++;
 			cache[pos] = std::make_shared<LineLayout>(lineNumber, maxChars);
+			cache[pos]->generation = generation;
 		}
 #ifdef CHECK_LLC
 		// Expensive check that there is only one entry for any line number
@@ -643,6 +969,7 @@ std::shared_ptr<LineLayout> LineLayoutCache::Retrieve(Sci::Line lineNumber, Sci:
 	}
 
 	// Only reach here for level == Cache::none
+	misses++;
 	return std::make_shared<LineLayout>(lineNumber, maxChars);
 }
 
@@ -887,12 +1214,13 @@ BreakFinder::BreakFinder(const LineLayout *ll_, const Selection *psel, Range lin
 		}
 	}
 	if (FlagSet(breakFor, BreakFor::Foreground) && pvsDraw->indicatorsSetFore) {
-		for (const IDecoration *deco : pdoc->decorations->View()) {
-			if (pvsDraw->indicators[deco->Indicator()].OverridesTextFore()) {
-				Sci::Position startPos = deco->EndRun(posLineStart);
-				while (startPos < (posLineStart + lineRange.end)) {
-					Insert(startPos - posLineStart);
-					startPos = deco->EndRun(startPos);
+		for (const LineLayout::IndicatorRuns &runsOfIndicator : ll->Indicators(pdoc, posLineStart)) {
+			if (pvsDraw->indicators[runsOfIndicator.indicator].OverridesTextFore()) {
+				for (const LineLayout::IndicatorRun &run : runsOfIndicator.runs) {
+					if ((run.start > 0) && (run.start < lineRange.end))
+						Insert(run.start);
+					if ((run.end > 0) && (run.end < lineRange.end))
+						Insert(run.end);
 				}
 			}
 		}
@@ -1017,6 +1345,9 @@ class PositionCache : public IPositionCache {
 	std::mutex mutex;
 	uint16_t clock;
 	bool allClear;
+	static bool MeasureFromStyle(Surface *surface, const Style &style, bool unicode, Sci::string_view sv, XYPOSITION *positions);
+	size_t Retrieve(unsigned int styleNumber, bool unicode, Sci::string_view sv, XYPOSITION *positions, bool needsLocking, bool &found);
+	void Store(size_t probe, unsigned int styleNumber, bool unicode, Sci::string_view sv, const XYPOSITION *positions, bool needsLocking);
 public:
 	PositionCache();
 	// Deleted so LineAnnotation objects can not be copied.
@@ -1031,6 +1362,8 @@ public:
 	size_t GetSize() const noexcept override;
 	void MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
 		bool unicode, Sci::string_view sv, XYPOSITION *positions, bool needsLocking) override;
+	void MeasureWidthsBatch(Surface *surface, const ViewStyle &vstyle, bool unicode,
+		const std::vector<SegmentMeasureRequest> &requests, bool needsLocking) override;
 };
 
 PositionCacheEntry::PositionCacheEntry() noexcept :
@@ -1127,19 +1460,48 @@ size_t PositionCache::GetSize() const noexcept {
 	return pces.size();
 }
 
-void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
-	bool unicode, Sci::string_view sv, XYPOSITION *positions, bool needsLocking) {
-	const Style &style = vstyle.styles[styleNumber];
+// Measure without the platform layer when the font's ASCII advances are known.
+bool PositionCache::MeasureFromStyle(Surface *surface, const Style &style,
+	bool unicode, Sci::string_view sv, XYPOSITION *positions) {
 	if (style.monospaceASCII) {
 		if (AllGraphicASCII(sv)) {
 			const XYPOSITION monospaceCharacterWidth = style.monospaceCharacterWidth;
 			for (size_t i = 0; i < sv.length(); i++) {
 				positions[i] = monospaceCharacterWidth * (i+1);
 			}
-			return;
+			return true;
+		}
+	} else if (style.asciiAdvances) {
+		if (AllGraphicASCII(sv)) {
+			const std::vector<XYPOSITION> &advances = *style.asciiAdvances;
+			XYPOSITION position = 0.0;
+			for (size_t i = 0; i < sv.length(); i++) {
+				position += advances[static_cast<unsigned char>(sv[i])];
+				positions[i] = position;
+			}
+			if (verifyASCIIAdvances) {
+				// Compare with platform measurement to find fonts incorrectly detected as context-free
+				std::vector<XYPOSITION> positionsPlatform(sv.length());
+				if (unicode) {
+					surface->MeasureWidthsUTF8(style.font.get(), sv, positionsPlatform.data());
+				} else {
+					surface->MeasureWidths(style.font.get(), sv, positionsPlatform.data());
+				}
+				for (size_t i = 0; i < sv.length(); i++) {
+					PLATFORM_ASSERT(std::abs(positions[i] - positionsPlatform[i]) < 0.01);
+				}
+			}
+			return true;
 		}
 	}
+	return false;
+}
 
+// Look up sv in the cache. When not found, return the slot to store it in or pces.size()
+// if it should not be stored.
+size_t PositionCache::Retrieve(unsigned int styleNumber, bool unicode, Sci::string_view sv,
+	XYPOSITION *positions, bool needsLocking, bool &found) {
+	found = false;
 	size_t probe = pces.size();	// Out of bounds
 	if ((!pces.empty()) && (sv.length() < 30)) {
 		// Only store short strings in the cache so it doesn't churn with
@@ -1153,24 +1515,24 @@ void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, uns
 			guard.lock();
 		}
 		if (pces[probe].Retrieve(styleNumber, unicode, sv, positions)) {
-			return;
+			found = true;
+			return probe;
 		}
 		const size_t probe2 = (hashValue * 37) % pces.size();
 		if (pces[probe2].Retrieve(styleNumber, unicode, sv, positions)) {
-			return;
+			found = true;
+			return probe2;
 		}
 		// Not found. Choose the oldest of the two slots to replace
 		if (pces[probe].NewerThan(pces[probe2])) {
 			probe = probe2;
 		}
 	}
+	return probe;
+}
 
-	const Font *fontStyle = style.font.get();
-	if (unicode) {
-		surface->MeasureWidthsUTF8(fontStyle, sv, positions);
-	} else {
-		surface->MeasureWidths(fontStyle, sv, positions);
-	}
+void PositionCache::Store(size_t probe, unsigned int styleNumber, bool unicode, Sci::string_view sv,
+	const XYPOSITION *positions, bool needsLocking) {
 	if (probe < pces.size()) {
 		// Store into cache
 		std::unique_lock<std::mutex> guard(mutex, std::defer_lock);
@@ -1191,6 +1553,69 @@ void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, uns
 	}
 }
 
+void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
+	bool unicode, Sci::string_view sv, XYPOSITION *positions, bool needsLocking) {
+	const Style &style = vstyle.styles[styleNumber];
+	if (MeasureFromStyle(surface, style, unicode, sv, positions)) {
+		return;
+	}
+
+	bool found = false;
+	const size_t probe = Retrieve(styleNumber, unicode, sv, positions, needsLocking, found);
+	if (found) {
+		return;
+	}
+
+	const Font *fontStyle = style.font.get();
+	if (unicode) {
+		surface->MeasureWidthsUTF8(fontStyle, sv, positions);
+	} else {
+		surface->MeasureWidths(fontStyle, sv, positions);
+	}
+	Store(probe, styleNumber, unicode, sv, positions, needsLocking);
+}
+
+void PositionCache::MeasureWidthsBatch(Surface *surface, const ViewStyle &vstyle, bool unicode,
+	const std::vector<SegmentMeasureRequest> &requests, bool needsLocking) {
+	if (!unicode) {
+		// Batching is only implemented for UTF-8
+		for (const SegmentMeasureRequest &request : requests) {
+			MeasureWidths(surface, vstyle, request.styleNumber, unicode, request.sv, request.positions, needsLocking);
+		}
+		return;
+	}
+
+	// Satisfy what is possible from styles and the cache then measure the rest together.
+	std::vector<TextMeasureRequest> misses;
+	std::vector<size_t> missIndices;
+	std::vector<size_t> probes;
+	for (size_t i = 0; i < requests.size(); i++) {
+		const SegmentMeasureRequest &request = requests[i];
+		const Style &style = vstyle.styles[request.styleNumber];
+		if (MeasureFromStyle(surface, style, unicode, request.sv, request.positions)) {
+			continue;
+		}
+		bool found = false;
+		const size_t probe = Retrieve(request.styleNumber, unicode, request.sv, request.positions, needsLocking, found);
+		if (!found) {
+			misses.push_back({style.font.get(), request.sv, request.positions});
+			missIndices.push_back(i);
+			probes.push_back(probe);
+		}
+	}
+
+	if (misses.empty()) {
+		return;
+	}
+	surface->MeasureWidthsBatchUTF8(misses.data(), misses.size());
+
+	for (size_t miss = 0; miss < misses.size(); miss++) {
+		const SegmentMeasureRequest &request = requests[missIndices[miss]];
+		// Two misses may share a slot so the later one wins, as with sequential measurement
+		Store(probes[miss], request.styleNumber, unicode, request.sv, request.positions, needsLocking);
+	}
+}
+
 std::unique_ptr<IPositionCache> Scintilla::Internal::CreatePositionCache() {
 	return Sci::make_unique<PositionCache>();
 }
@@ -44,12 +44,23 @@ public:
 	void Resize(size_t maxLineLength_);
 };
 
+// Copy of the measured parts of a LineLayout that is not currently in use.
+// Positions are only stored where they change so UTF-8 trail bytes take no space.
+class CompactLayout {
+public:
+	std::vector<char> chars;
+	std::vector<unsigned char> styles;
+	std::vector<float> positions;
+	std::vector<bool> repeats;
+};
+
 /**
  */
 class LineLayout {
 private:
 	std::unique_ptr<int []>lineStarts;
 	int lenLineStarts;
+	std::unique_ptr<CompactLayout> compact;
 	/// Drawing is only performed for @a maxLineLength characters on each line.
 	Sci::Line lineNumber;
 public:
@@ -70,11 +81,41 @@ public:
 
 	std::unique_ptr<BidiData> bidiData;
 
+	// Segments of text shaped by the platform while drawing so later paints of an unchanged
+	// line can draw them without shaping again. Mutable as drawing only sees a const layout.
+	struct ShapedSegment {
+		int start;
+		int length;
+		const Font *font;
+		std::shared_ptr<ShapedText> shaped;
+	};
+	mutable std::vector<ShapedSegment> shapedSegments;
+
+	// Indicator runs with non-zero values that overlap this line, gathered once so drawing
+	// and breaking don't repeat the searches for each use. Positions are relative to the
+	// line start and are the whole run so may extend before or after the line.
+	struct IndicatorRun {
+		Sci::Position start;
+		Sci::Position end;
+		int value;
+	};
+	struct IndicatorRuns {
+		int indicator;
+		std::vector<IndicatorRun> runs;
+		const IndicatorRun *RunContaining(Sci::Position position) const noexcept;
+	};
+	mutable std::vector<IndicatorRuns> indicatorRuns;
+	mutable Sci::Line indicatorRunsLine;
+	mutable unsigned int indicatorRunsVersion;
+
 	// Wrapped line support
 	int widthLine;
 	int lines;
 	XYPOSITION wrapIndent; // In pixels
 
+	// Last LineLayoutCache invalidation generation applied to this layout
+	size_t generation;
+
 	LineLayout(Sci::Line lineNumber_, int maxLineLength_);
 	// Deleted so LineLayout objects can not be copied.
 	LineLayout(const LineLayout &) = delete;
@@ -87,9 +128,15 @@ public:
 	void EnsureBidiData();
 	void Free() noexcept;
 	void ClearPositions();
+	void ClearShapedText() noexcept;
+	void ClearIndicatorRuns() noexcept;
 	void Invalidate(ValidLevel validity_) noexcept;
+	void Compact();
+	void Expand();
+	bool Compacted() const noexcept { return compact != nullptr; }
 	Sci::Line LineNumber() const noexcept;
 	bool CanHold(Sci::Line lineDoc, int lineLength_) const noexcept;
+	size_t MemoryUsage() const noexcept;
 	int LineStart(int line) const noexcept;
 	int LineLength(int line) const noexcept;
 	enum class Scope { visibleOnly, includeEnd };
@@ -108,6 +155,8 @@ public:
 	Interval Span(int start, int end) const noexcept;
 	Interval SpanByte(int index) const noexcept;
 	int EndLineStyle() const noexcept;
+	const ShapedText *ShapeSegment(Surface *surface, const Font *font, int start, int length) const;
+	const std::vector<IndicatorRuns> &Indicators(const Document *pdoc, Sci::Position posLineStart) const;
 	void WrapLine(const Document *pdoc, Sci::Position posLineStart, Wrap wrapState, XYPOSITION wrapWidth);
 };
 
@@ -149,17 +198,33 @@ struct SignificantLines {
 	bool LineMayCache(Sci::Line line) const noexcept;
 };
 
+class LineLayoutBudget;
+
 /**
  */
 class LineLayoutCache {
 public:
+	static constexpr size_t bytesBudgetDefault = 32 * 1024 * 1024;
 private:
 	Scintilla::LineCache level;
 	std::vector<std::shared_ptr<LineLayout>>cache;
+	// Least recently used layouts for LineCache::Budget limited to bytesBudget
+	std::unique_ptr<LineLayoutBudget> budget;
+	size_t bytesBudget;
+	bool compactLayouts;
+	size_t hits;
+	size_t misses;
 	LineLayout::ValidLevel maxValidity;
+	// Invalidations are counted as generations and only applied to each layout when it is retrieved
+	static constexpr size_t validLevels = static_cast<size_t>(LineLayout::ValidLevel::lines) + 1;
+	size_t generation;
+	size_t generationInvalidated[validLevels];
 	int styleClock;
 	size_t EntryForLine(Sci::Line line) const noexcept;
 	void AllocateForLevel(Sci::Line linesOnScreen, Sci::Line linesInDoc);
+	void ApplyInvalidations(LineLayout &ll) const noexcept;
+	void CountRetrieval(const LineLayout &ll) noexcept;
+	std::shared_ptr<LineLayout> RetrieveBudgeted(Sci::Line lineNumber, int maxChars, Sci::Line linesOnScreen);
 public:
 	LineLayoutCache();
 	// Deleted so LineLayoutCache objects can not be copied.
@@ -172,6 +237,13 @@ public:
 	void Invalidate(LineLayout::ValidLevel validity_) noexcept;
 	void SetLevel(Scintilla::LineCache level_) noexcept;
 	Scintilla::LineCache GetLevel() const noexcept { return level; }
+	void SetBudget(size_t bytesBudget_);
+	size_t GetBudget() const noexcept { return bytesBudget; }
+	void SetCompact(bool compact_) noexcept { compactLayouts = compact_; }
+	bool GetCompact() const noexcept { return compactLayouts; }
+	size_t Hits() const noexcept { return hits; }
+	size_t Misses() const noexcept { return misses; }
+	void CountChecked(bool reused) noexcept;
 	std::shared_ptr<LineLayout> Retrieve(Sci::Line lineNumber, Sci::Line lineCaret, int maxChars, int styleClock_,
 		Sci::Line linesOnScreen, Sci::Line linesInDoc);
 };
@@ -263,6 +335,12 @@ public:
 	bool More() const noexcept;
 };
 
+struct SegmentMeasureRequest {
+	unsigned int styleNumber;
+	Sci::string_view sv;
+	XYPOSITION *positions;
+};
+
 class IPositionCache {
 public:
 	virtual ~IPositionCache() = default;
@@ -271,6 +349,8 @@ public:
 	virtual size_t GetSize() const noexcept = 0;
 	virtual void MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
 		bool unicode, Sci::string_view sv, XYPOSITION *positions, bool needsLocking) = 0;
+	virtual void MeasureWidthsBatch(Surface *surface, const ViewStyle &vstyle, bool unicode,
+		const std::vector<SegmentMeasureRequest> &requests, bool needsLocking) = 0;
 };
 
 std::unique_ptr<IPositionCache> CreatePositionCache();
@@ -819,6 +819,9 @@ void ScintillaBase::NotifyStyleToNeeded(Sci::Position endStyleNeeded) {
 }
 
 sptr_t ScintillaBase::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
+	// Deferred appends are committed before any other API message can see the document.
+	// Platform layers commit for the few API messages they handle that read the document.
+	CommitAppendedBefore(iMessage);
 	switch (iMessage) {
 	case Message::AutoCShow:
 		listType = 0;
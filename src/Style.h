@@ -36,6 +36,9 @@ struct FontMeasurements {
 	XYPOSITION monospaceCharacterWidth = 1;
 	XYPOSITION spaceWidth = 1;
 	bool monospaceASCII = false;
+	// Advance of each ASCII character when the font has no kerning or ligatures
+	// for ASCII so runs can be measured by summing. Null when context-dependent.
+	std::shared_ptr<const std::vector<XYPOSITION>> asciiAdvances;
 	int sizeZoomed = 2;
 };
 
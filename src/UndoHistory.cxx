@@ -126,7 +126,7 @@ size_t ScaledVector::SizeInBytes() const noexcept {
 	return bytes.size();
 }
 
-UndoActionType::UndoActionType() noexcept : at(ActionType::insert), mayCoalesce(false) {
+UndoActionType::UndoActionType() noexcept : at(ActionType::insert), mayCoalesce(false), replacing(false) {
 }
 
 UndoActions::UndoActions() = default;
@@ -154,9 +154,10 @@ intptr_t UndoActions::SSize() const noexcept {
 	return types.size();
 }
 
-void UndoActions::Create(size_t index, ActionType at_, Sci::Position position_, Sci::Position lenData_, bool mayCoalesce_) {
+void UndoActions::Create(size_t index, ActionType at_, Sci::Position position_, Sci::Position lenData_, bool mayCoalesce_, bool replacing_) {
 	types[index].at = at_;
 	types[index].mayCoalesce = mayCoalesce_;
+	types[index].replacing = replacing_;
 	positions.SetValueAt(index, position_);
 	lengths.SetValueAt(index, lenData_);
 }
@@ -249,7 +250,7 @@ UndoHistory::UndoHistory() {
 UndoHistory::~UndoHistory() noexcept = default;
 
 const char *UndoHistory::AppendAction(ActionType at, Sci::Position position, const char *data, Sci::Position lengthData,
-	bool &startSequence, bool mayCoalesce) {
+	bool &startSequence, bool mayCoalesce, bool replacing) {
 	//Platform::DebugPrintf("%% %d action %d %d %d\n", at, position, lengthData, currentAction);
 	//Platform::DebugPrintf("^ %d action %d %d\n", actions[currentAction - 1].at,
 	//	actions[currentAction - 1].position, actions[currentAction - 1].lenData);
@@ -325,7 +326,7 @@ const char *UndoHistory::AppendAction(ActionType at, Sci::Position position, con
 	} else {
 		actions.Truncate(currentAction+1);
 	}
-	actions.Create(currentAction, at, position, lengthData, mayCoalesce);
+	actions.Create(currentAction, at, position, lengthData, mayCoalesce, replacing);
 	currentAction++;
 	return dataNew;
 }
@@ -475,7 +476,8 @@ int UndoHistory::Current() const noexcept {
 int UndoHistory::Type(int action) const noexcept {
 	const int baseType = static_cast<int>(actions.types[action].at);
 	const int open = actions.types[action].mayCoalesce ? coalesceFlag : 0;
-	return baseType | open;
+	const int replacing = actions.types[action].replacing ? replaceFlag : 0;
+	return baseType | open | replacing;
 }
 
 Sci::Position UndoHistory::Position(int action) const noexcept {
@@ -510,7 +512,7 @@ Sci::string_view UndoHistory::Text(int action) noexcept {
 void UndoHistory::PushUndoActionType(int type, Sci::Position position) {
 	actions.PushBack();
 	actions.Create(actions.SSize()-1, static_cast<ActionType>(type & byteMask),
-		position, 0, type & coalesceFlag);
+		position, 0, type & coalesceFlag, type & replaceFlag);
 }
 
 void UndoHistory::ChangeLastUndoActionText(size_t length, const char *text) {
@@ -631,4 +633,52 @@ void UndoHistory::CompletedRedoStep() noexcept {
 	currentAction++;
 }
 
+bool UndoHistory::UndoStepIsReplacement() const noexcept {
+	const int previousAction = PreviousAction();
+	return (previousAction >= 1) &&
+		(actions.types[previousAction].at == ActionType::insert) &&
+		actions.types[previousAction].replacing &&
+		(actions.types[previousAction - 1].at == ActionType::remove) &&
+		(actions.Position(previousAction - 1) == actions.Position(previousAction));
+}
+
+Action UndoHistory::GetUndoReplacedStep() const noexcept {
+	const int previousAction = PreviousAction();
+	const int replacedAction = previousAction - 1;
+	Action acta {
+		actions.types[replacedAction].at,
+		actions.types[replacedAction].mayCoalesce,
+		actions.Position(replacedAction),
+		nullptr,
+		actions.Length(replacedAction)
+	};
+	if (acta.lenData) {
+		acta.data = scraps->CurrentText() - actions.Length(previousAction) - acta.lenData;
+	}
+	return acta;
+}
+
+bool UndoHistory::RedoStepIsReplacement() const noexcept {
+	return (currentAction + 1 < actions.SSize()) &&
+		(actions.types[currentAction].at == ActionType::remove) &&
+		(actions.types[currentAction + 1].at == ActionType::insert) &&
+		actions.types[currentAction + 1].replacing &&
+		(actions.Position(currentAction) == actions.Position(currentAction + 1));
+}
+
+Action UndoHistory::GetRedoReplacingStep() const noexcept {
+	const int replacingAction = currentAction + 1;
+	Action acta {
+		actions.types[replacingAction].at,
+		actions.types[replacingAction].mayCoalesce,
+		actions.Position(replacingAction),
+		nullptr,
+		actions.Length(replacingAction)
+	};
+	if (acta.lenData) {
+		acta.data = scraps->CurrentText() + actions.Length(currentAction);
+	}
+	return acta;
+}
+
 }}
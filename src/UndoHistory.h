@@ -44,6 +44,7 @@ class UndoActionType {
 public:
 	ActionType at : 4;
 	bool mayCoalesce : 1;
+	bool replacing : 1;
 	UndoActionType() noexcept;
 };
 
@@ -57,7 +58,7 @@ struct UndoActions {
 	void PushBack();
 	void Clear() noexcept;
 	SCI_NODISCARD intptr_t SSize() const noexcept;
-	void Create(size_t index, ActionType at_, Sci::Position position_, Sci::Position lenData_, bool mayCoalesce_);
+	void Create(size_t index, ActionType at_, Sci::Position position_, Sci::Position lenData_, bool mayCoalesce_, bool replacing_=false);
 	SCI_NODISCARD bool AtStart(size_t index) const noexcept;
 	SCI_NODISCARD size_t LengthTo(size_t index) const noexcept;
 	SCI_NODISCARD Sci::Position Position(int action) const noexcept;
@@ -78,6 +79,9 @@ public:
 };
 
 constexpr int coalesceFlag = 0x100;
+// Set on an insertion that replaces the text removed by the previous action at the same
+// position without changing lines so the pair is undone and redone as one step
+constexpr int replaceFlag = 0x200;
 
 /**
  *
@@ -99,7 +103,7 @@ public:
 	UndoHistory();
 	~UndoHistory() noexcept;
 
-	const char *AppendAction(ActionType at, Sci::Position position, const char *data, Sci::Position lengthData, bool &startSequence, bool mayCoalesce=true);
+	const char *AppendAction(ActionType at, Sci::Position position, const char *data, Sci::Position lengthData, bool &startSequence, bool mayCoalesce=true, bool replacing=false);
 
 	void BeginUndoAction(bool mayCoalesce=false) noexcept;
 	void EndUndoAction() noexcept;
@@ -155,6 +159,14 @@ public:
 	int StartRedo() const noexcept;
 	Action GetRedoStep() const noexcept;
 	void CompletedRedoStep() noexcept;
+
+	/// A replacement is a removal followed by a replacing insertion that are performed together.
+	/// When UndoStepIsReplacement, GetUndoStep is the insertion and GetUndoReplacedStep the removal.
+	/// When RedoStepIsReplacement, GetRedoStep is the removal and GetRedoReplacingStep the insertion.
+	SCI_NODISCARD bool UndoStepIsReplacement() const noexcept;
+	Action GetUndoReplacedStep() const noexcept;
+	SCI_NODISCARD bool RedoStepIsReplacement() const noexcept;
+	Action GetRedoReplacingStep() const noexcept;
 };
 
 }}
@@ -79,14 +79,16 @@ void FontRealised::Realise(Surface &surface, int zoomLevel, Technology technolog
 	measurements.monospaceCharacterWidth = measurements.aveCharWidth;
 	measurements.spaceWidth = surface.WidthText(font.get(), " ");
 
+	// "Ay" is normally strongly kerned and "fi" may be a ligature
+	const char allASCIIGraphic[] = "Ayfi"
+	// python: ''.join(chr(ch) for ch in range(32, 127))
+	" !\"#$%&\'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
+	std::array<XYPOSITION, sizeof(allASCIIGraphic) - 1> positions {};
+	surface.MeasureWidthsUTF8(font.get(), allASCIIGraphic, positions.data());
+	std::adjacent_difference(positions.begin(), positions.end(), positions.begin());
+
+	measurements.monospaceASCII = false;
 	if (fs.checkMonospaced) {
-		// "Ay" is normally strongly kerned and "fi" may be a ligature
-		const char allASCIIGraphic[] = "Ayfi"
-		// python: ''.join(chr(ch) for ch in range(32, 127))
-		" !\"#$%&\'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
-		std::array<XYPOSITION, sizeof(allASCIIGraphic) - 1> positions {};
-		surface.MeasureWidthsUTF8(font.get(), allASCIIGraphic, positions.data());
-		std::adjacent_difference(positions.begin(), positions.end(), positions.begin());
 		const XYPOSITION maxWidth = *std::max_element(positions.begin(), positions.end());
 		const XYPOSITION minWidth = *std::min_element(positions.begin(), positions.end());
 		const XYPOSITION variance = maxWidth - minWidth;
@@ -94,8 +96,36 @@ void FontRealised::Realise(Surface &surface, int zoomLevel, Technology technolog
 		constexpr XYPOSITION monospaceWidthEpsilon = 0.000001;	// May need tweaking if monospace fonts vary more
 		measurements.monospaceASCII = scaledVariance < monospaceWidthEpsilon;
 		measurements.monospaceCharacterWidth = minWidth;
-	} else {
-		measurements.monospaceASCII = false;
+	}
+
+	measurements.asciiAdvances.reset();
+	if (!measurements.monospaceASCII) {
+		// Check whether proportional ASCII advances are independent of context by
+		// predicting the layout of text with common kerning pairs and ligatures
+		// in a different order from the advances measured above.
+		auto advances = std::make_shared<std::vector<XYPOSITION>>(0x80);
+		for (size_t i = 0; i < positions.size(); i++) {
+			(*advances)[static_cast<unsigned char>(allASCIIGraphic[i])] = positions[i];
+		}
+		const char kerningProbe[] = "AVAWATAYLTLVLYPATaTeToVaWaYaFaKvrnffiflff"
+		// Reversed order of allASCIIGraphic puts each character next to different neighbours
+		"~}|{zyxwvutsrqponmlkjihgfedcba`_^]\\[ZYXWVUTSRQPONMLKJIHGFEDCBA@?>=<;:9876543210/.-,+*)(\'&%$#\"! ";
+		std::array<XYPOSITION, sizeof(kerningProbe) - 1> positionsProbe {};
+		surface.MeasureWidthsUTF8(font.get(), kerningProbe, positionsProbe.data());
+		constexpr XYPOSITION advanceEpsilon = 0.0001;	// Relative to aveCharWidth
+		const XYPOSITION maxDifference = advanceEpsilon * measurements.aveCharWidth;
+		XYPOSITION predicted = 0.0;
+		bool contextFree = true;
+		for (size_t i = 0; i < positionsProbe.size(); i++) {
+			predicted += (*advances)[static_cast<unsigned char>(kerningProbe[i])];
+			if (std::abs(predicted - positionsProbe[i]) > maxDifference) {
+				contextFree = false;
+				break;
+			}
+		}
+		if (contextFree) {
+			measurements.asciiAdvances = std::move(advances);
+		}
 	}
 }
 
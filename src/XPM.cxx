@@ -112,6 +112,7 @@ void XPM::Init(const char *const *linesForm) {
 	nColours = 1;
 	pixels.clear();
 	codeTransparent = ' ';
+	image.reset();
 	if (!linesForm)
 		return;
 
@@ -157,6 +158,12 @@ void XPM::Draw(Surface *surface, const PRectangle &rc) {
 	// Centre the pixmap
 	const int startY = static_cast<int>(rc.top + (rc.Height() - height) / 2);
 	const int startX = static_cast<int>(rc.left + (rc.Width() - width) / 2);
+	if (!image) {
+		image = std::make_shared<RGBAImage>(*this);
+	}
+	if (image->DrawCached(surface, PRectangle::FromInts(startX, startY, startX + width, startY + height))) {
+		return;
+	}
 	for (int y=0; y<height; y++) {
 		int prevCode = 0;
 		int xStartRun = 0;
@@ -254,6 +261,7 @@ const unsigned char *RGBAImage::Pixels() const noexcept {
 }
 
 void RGBAImage::SetPixel(int x, int y, ColourRGBA colour) noexcept {
+	handle.reset();
 	unsigned char *pixel = pixelBytes.data() + (y * width + x) * 4;
 	// RGBA
 	pixel[0] = colour.GetRed();
@@ -262,6 +270,21 @@ void RGBAImage::SetPixel(int x, int y, ColourRGBA colour) noexcept {
 	pixel[3] = colour.GetAlpha();
 }
 
+bool RGBAImage::DrawCached(Surface *surface, PRectangle rc) const {
+	if (handle && surface->DrawImageHandle(rc, handle.get())) {
+		return true;
+	}
+	// No handle yet or made by an incompatible surface
+	handle = surface->CreateImageHandle(width, height, Pixels());
+	return handle && surface->DrawImageHandle(rc, handle.get());
+}
+
+void RGBAImage::Draw(Surface *surface, PRectangle rc) const {
+	if (!DrawCached(surface, rc)) {
+		surface->DrawRGBAImage(rc, width, height, Pixels());
+	}
+}
+
 namespace {
 
 constexpr unsigned char AlphaMultiplied(unsigned char value, unsigned char alpha) noexcept {
@@ -10,6 +10,8 @@
 
 namespace Scintilla { namespace Internal {
 
+class RGBAImage;
+
 /**
  * Hold a pixmap in XPM format.
  */
@@ -20,6 +22,7 @@ class XPM {
 	std::vector<unsigned char> pixels;
 	ColourRGBA colourCodeTable[256];
 	char codeTransparent=' ';
+	std::shared_ptr<RGBAImage> image;	///< RGBA form for drawing through an ImageHandle, made on first draw
 	ColourRGBA ColourFromCode(int ch) const noexcept;
 	void FillRun(Surface *surface, int code, int startX, int y, int x) const;
 public:
@@ -44,6 +47,7 @@ class RGBAImage {
 	int width;
 	float scale;
 	std::vector<unsigned char> pixelBytes;
+	mutable std::shared_ptr<ImageHandle> handle;	///< Platform form of pixelBytes, made on first draw
 public:
 	static constexpr size_t bytesPerPixel = 4;
 	RGBAImage(int width_, int height_, float scale_, const unsigned char *pixels_);
@@ -56,6 +60,10 @@ public:
 	int CountBytes() const noexcept;
 	const unsigned char *Pixels() const noexcept;
 	void SetPixel(int x, int y, ColourRGBA colour) noexcept;
+	/// Draw through an ImageHandle, returning false if the surface does not support them
+	bool DrawCached(Surface *surface, PRectangle rc) const;
+	/// Draw through an ImageHandle when possible, otherwise with DrawRGBAImage
+	void Draw(Surface *surface, PRectangle rc) const;
 	static void BGRAFromRGBA(unsigned char *pixelsBGRA, const unsigned char *pixelsRGBA, size_t count) noexcept;
 };
 
@@ -738,6 +738,22 @@ class TestSimple(unittest.TestCase):
 		self.assertEqual(self.ed.SelectionEnd, 0)
 		self.assertEqual(self.ed.Contents(), b"abc12")
 
+	def testAppendDeferred(self):
+		self.ed.SetContents(b"abc")
+		self.assertEqual(self.ed.AppendLineLimit, 0)
+		self.ed.AppendTextDeferred(2, b"12")
+		self.ed.AppendTextDeferred(2, b"34")
+		# Any other message adds the held text first
+		self.assertEqual(self.ed.Length, 7)
+		self.assertEqual(self.ed.Contents(), b"abc1234")
+		self.assertEqual(self.ed.SelectionStart, 0)
+		self.ed.AppendLineLimit = 3
+		self.assertEqual(self.ed.AppendLineLimit, 3)
+		text = b"\nx\ny\nz\n"
+		self.ed.AppendTextDeferred(len(text), text)
+		self.assertEqual(self.ed.Contents(), b"y\nz\n")
+		self.ed.AppendLineLimit = 0
+
 	def testTarget(self):
 		self.ed.SetContents(b"abcd")
 		self.ed.TargetStart = 1
@@ -803,6 +819,27 @@ class TestSimple(unittest.TestCase):
 		self.ed.ReplaceTargetMinimal(len(rep), rep)
 		self.assertEqual(self.ed.Contents(), b"a3cd")
 
+	def testReplaceTargetDiff(self):
+		self.ed.SetContents(b"a\nb\nc\nd\n")
+		self.ed.MarkerAdd(3, 1)
+		self.ed.TargetWholeDocument()
+		rep = b"a\nB\nc\nnew\nd\n"
+		self.assertEqual(self.ed.ReplaceTargetDiff(len(rep), rep), len(rep))
+		self.assertEqual(self.ed.Contents(), rep)
+		self.assertEqual(self.ed.MarkerGet(4), 2)
+		self.assertEqual(self.ed.TargetEnd, len(rep))
+
+	def testReplaceAllInTarget(self):
+		self.ed.SetContents(b"ab ab\nab")
+		self.ed.TargetWholeDocument()
+		self.ed.SearchFlags = self.ed.SCFIND_MATCHCASE
+		self.ed.SetReplaceAllSearch(2, b"ab")
+		self.assertEqual(self.ed.ReplaceAllInTarget(3, b"xyz"), 3)
+		self.assertEqual(self.ed.Contents(), b"xyz xyz\nxyz")
+		self.assertEqual(self.ed.TargetEnd, self.ed.Length)
+		self.ed.Undo()
+		self.assertEqual(self.ed.Contents(), b"ab ab\nab")
+
 	def testTargetWhole(self):
 		self.ed.SetContents(b"abcd")
 		self.ed.TargetStart = 1
@@ -1551,6 +1588,42 @@ class TestScrolling(unittest.TestCase):
 		self.ed.FirstVisibleLine = 7
 		self.assertEqual(self.ed.FirstVisibleLine, 7)
 
+	def testLayoutCacheBudget(self):
+		originalCache = self.ed.LayoutCache
+		originalBudget = self.ed.LayoutCacheBudget
+		self.ed.LayoutCache = self.ed.SC_CACHE_BUDGET
+		self.assertEqual(self.ed.LayoutCache, self.ed.SC_CACHE_BUDGET)
+		# Changing the cache mode resets the statistics
+		self.assertEqual(self.ed.LayoutCacheHits, 0)
+		self.assertEqual(self.ed.LayoutCacheMisses, 0)
+		self.ed.LayoutCacheBudget = 100000
+		self.assertEqual(self.ed.LayoutCacheBudget, 100000)
+		# Measuring the same line twice should find it the second time
+		self.ed.PointXFromPosition(0, 10)
+		self.ed.PointXFromPosition(0, 20)
+		self.assertGreater(self.ed.LayoutCacheMisses, 0)
+		self.assertGreater(self.ed.LayoutCacheHits, 0)
+		self.assertEqual(self.ed.LayoutCacheCompact, 0)
+		self.ed.LayoutCacheCompact = 1
+		self.assertEqual(self.ed.LayoutCacheCompact, 1)
+		# Lines move out of view so are compacted then restored when scrolled back
+		xBefore = self.ed.PointXFromPosition(0, 10)
+		self.ed.LineScroll(0, 140)
+		self.ed.LineScroll(0, -140)
+		self.assertEqual(self.ed.PointXFromPosition(0, 10), xBefore)
+		self.ed.LayoutCacheCompact = 0
+		self.ed.LayoutCacheBudget = originalBudget
+		self.ed.LayoutCache = originalCache
+
+	def testScrollWidthExact(self):
+		self.assertEqual(self.ed.ScrollWidthExact, 0)
+		self.ed.ScrollWidthExact = 1
+		self.assertEqual(self.ed.ScrollWidthExact, 1)
+		# An estimate is available immediately
+		self.assertGreater(self.ed.ScrollWidth, 0)
+		self.ed.ScrollWidthExact = 0
+		self.assertEqual(self.ed.ScrollWidthExact, 0)
+
 class TestSearch(unittest.TestCase):
 
 	def setUp(self):
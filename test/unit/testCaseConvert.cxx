@@ -0,0 +1,130 @@
+/** @file testCaseConvert.cxx
+ ** Unit Tests for Scintilla internal data structures
+ **/
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <memory>
+
+#include "Debugging.h"
+
+#include "CaseConvert.h"
+#include "UniConversion.h"
+
+#include "catch.hpp"
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+namespace Scintilla { namespace Internal {
+
+// Defined in CaseConvert.cxx only for checking the lookup tables
+std::vector<std::pair<int, std::string>> CaseConversionsSorted(CaseConversion conversion);
+
+}}
+
+// Test CaseConvert.
+
+namespace {
+
+std::string Converted(int character, CaseConversion conversion) {
+	const char *converted = CaseConvert(character, conversion);
+	return converted ? converted : "";
+}
+
+}
+
+TEST_CASE("CaseConvert") {
+
+	SECTION("ASCII") {
+		REQUIRE(Converted('a', CaseConversion::upper) == "A");
+		REQUIRE(Converted('Z', CaseConversion::lower) == "z");
+		REQUIRE(Converted('Q', CaseConversion::fold) == "q");
+		REQUIRE(Converted('A', CaseConversion::upper) == "");
+		REQUIRE(Converted('1', CaseConversion::fold) == "");
+	}
+
+	SECTION("NonASCII") {
+		// Greek capital gamma and small gamma
+		REQUIRE(Converted(0x393, CaseConversion::lower) == "\xCE\xB3");
+		REQUIRE(Converted(0x3B3, CaseConversion::upper) == "\xCE\x93");
+		// Cyrillic capital be folds to small be
+		REQUIRE(Converted(0x411, CaseConversion::fold) == "\xD0\xB1");
+		// Sharp s expands to SS
+		REQUIRE(Converted(0xDF, CaseConversion::upper) == "SS");
+		// Ligature ffi in last page of the Basic Multilingual Plane
+		REQUIRE(Converted(0xFB03, CaseConversion::upper) == "FFI");
+		// Deseret in a supplementary plane
+		REQUIRE(Converted(0x10400, CaseConversion::lower) == "\xF0\x90\x90\xA8");
+		// CJK has no case
+		REQUIRE(Converted(0x4E00, CaseConversion::upper) == "");
+	}
+
+	SECTION("OutOfRange") {
+		REQUIRE(CaseConvert(-1, CaseConversion::fold) == nullptr);
+		REQUIRE(CaseConvert(0x110000, CaseConversion::upper) == nullptr);
+		REQUIRE(CaseConvert(0x7FFFFFFF, CaseConversion::lower) == nullptr);
+	}
+
+	SECTION("CharacterMatchesString") {
+		// Every character converts the same when looked up directly or within a string
+		const CaseConversion conversions[] = { CaseConversion::fold, CaseConversion::upper, CaseConversion::lower };
+		for (const CaseConversion conversion : conversions) {
+			size_t converting = 0;
+			size_t mismatches = 0;
+			for (int character = 1; character <= 0x10FFFF; character++) {
+				if (character >= 0xD800 && character <= 0xDFFF) {
+					// Surrogates are not valid in UTF-8
+					continue;
+				}
+				char utf8[UTF8MaxBytes + 1]{};
+				UTF8FromUTF32Character(character, utf8);
+				const size_t lenUTF8 = strlen(utf8);
+				const std::string viaString = CaseConvertString(std::string(utf8, lenUTF8), conversion);
+				const char *direct = CaseConvert(character, conversion);
+				if (direct) {
+					converting++;
+				}
+				if (viaString != (direct ? std::string(direct) : std::string(utf8, lenUTF8))) {
+					mismatches++;
+				}
+			}
+			REQUIRE(converting > 1000);
+			REQUIRE(mismatches == 0);
+		}
+	}
+
+	SECTION("MatchesSortedSearch") {
+		// Every code point converts the same as a binary search over the sorted conversions
+		// which is how conversions were found before the two stage table.
+		const CaseConversion conversions[] = { CaseConversion::fold, CaseConversion::upper, CaseConversion::lower };
+		for (const CaseConversion conversion : conversions) {
+			const std::vector<std::pair<int, std::string>> sorted = CaseConversionsSorted(conversion);
+			REQUIRE(sorted.size() > 1000);
+			size_t mismatches = 0;
+			for (int character = 0; character <= 0x10FFFF; character++) {
+				const auto it = std::lower_bound(sorted.begin(), sorted.end(), character,
+					[](const std::pair<int, std::string> &characterConversion, int ch) {
+						return characterConversion.first < ch;
+					});
+				const std::string expected = ((it != sorted.end()) && (it->first == character)) ? it->second : "";
+				if (Converted(character, conversion) != expected) {
+					mismatches++;
+				}
+			}
+			REQUIRE(mismatches == 0);
+		}
+	}
+
+	SECTION("MixedString") {
+		const std::string mixed = "Hello \xCE\x93\xCE\xB3 World \xD0\x91\xD0\xB1 long ASCII run to cross blocks \xC3\x9F";
+		REQUIRE(CaseConvertString(mixed, CaseConversion::upper) ==
+			"HELLO \xCE\x93\xCE\x93 WORLD \xD0\x91\xD0\x91 LONG ASCII RUN TO CROSS BLOCKS SS");
+		REQUIRE(CaseConvertString(mixed, CaseConversion::lower) ==
+			"hello \xCE\xB3\xCE\xB3 world \xD0\xB1\xD0\xB1 long ascii run to cross blocks \xC3\x9F");
+	}
+}
@@ -220,6 +220,50 @@ TEST_CASE("CellBuffer") {
 		REQUIRE(!cb.CanRedo());
 	}
 
+	SECTION("ReplaceKeepingLines") {
+		constexpr Sci::string_view sLines = "ab\ncd\r\nef";
+		constexpr Sci::string_view sReplaced = "abbb\nd\ref";
+		bool startSequence = false;
+		cb.InsertString(0, sLines.data(), sLines.length(), startSequence);
+		REQUIRE(3 == cb.Lines());
+		// Adding a line or splitting the CR LF pair does not keep lines
+		REQUIRE(!cb.ReplaceKeepsLines(0, "ab\ncd", "ab\n\ncd"));
+		REQUIRE(!cb.ReplaceKeepsLines(3, "cd\r", "cd\n"));
+		REQUIRE(!cb.ReplaceKeepsLines(0, "ab", ""));
+		// Changing the kind of line end keeps lines
+		REQUIRE(cb.ReplaceKeepsLines(1, "b\ncd\r\ne", "bbb\nd\re"));
+		std::vector<LineChange> changes;
+		cb.ReplaceKeepingLines(1, "b\ncd\r\ne", "bbb\nd\re", changes, startSequence);
+		REQUIRE(startSequence);
+		REQUIRE(Equal(cb.BufferPointer(), sReplaced));
+		REQUIRE(3 == cb.Lines());
+		REQUIRE(5 == cb.LineStart(1));
+		REQUIRE(7 == cb.LineStart(2));
+		// Only the changed part of each line is reported
+		REQUIRE(changes.size() == 2);
+		REQUIRE(changes[0].position == 2);
+		REQUIRE(changes[0].lengthRemoved == 0);
+		REQUIRE(changes[0].lengthInserted == 2);
+		REQUIRE(changes[1].position == 3);
+		REQUIRE(changes[1].lengthRemoved == 4);
+		REQUIRE(changes[1].lengthInserted == 2);
+
+		// Undone and redone as one step
+		REQUIRE(cb.StartUndo() == 2);
+		REQUIRE(cb.UndoStepIsReplacement());
+		cb.PerformUndoReplacement(changes);
+		REQUIRE(Equal(cb.BufferPointer(), sLines));
+		REQUIRE(3 == cb.LineStart(1));
+		REQUIRE(7 == cb.LineStart(2));
+		REQUIRE(changes.size() == 2);
+		REQUIRE(cb.StartRedo() == 2);
+		REQUIRE(cb.RedoStepIsReplacement());
+		cb.PerformRedoReplacement(changes);
+		REQUIRE(Equal(cb.BufferPointer(), sReplaced));
+		REQUIRE(7 == cb.LineStart(2));
+		REQUIRE(!cb.CanRedo());
+	}
+
 	SECTION("LineEndTypes") {
 		REQUIRE(cb.GetLineEndTypes() == LineEndType::Default);
 		cb.SetLineEndTypes(LineEndType::Unicode);
@@ -1306,19 +1350,77 @@ History HistoryOf(const CellBuffer &cb) {
 void UndoBlock(CellBuffer &cb) {
 	const int steps = cb.StartUndo();
 	for (int step = 0; step < steps; step++) {
-		cb.PerformUndoStep();
+		if (cb.UndoStepIsReplacement() && (step + 1 < steps)) {
+			std::vector<LineChange> changes;
+			cb.PerformUndoReplacement(changes);
+			step++;
+		} else {
+			cb.PerformUndoStep();
+		}
 	}
 }
 
 void RedoBlock(CellBuffer &cb) {
 	const int steps = cb.StartRedo();
 	for (int step = 0; step < steps; step++) {
-		cb.PerformRedoStep();
+		if (cb.RedoStepIsReplacement() && (step + 1 < steps)) {
+			std::vector<LineChange> changes;
+			cb.PerformRedoReplacement(changes);
+			step++;
+		} else {
+			cb.PerformRedoStep();
+		}
 	}
 }
 
 TEST_CASE("CellBufferWithChangeHistory") {
 
+	SECTION("ReplaceKeepingLines") {
+		// Same change history as separately editing the changed part of each line
+		constexpr Sci::string_view sOriginal = "one\ntwo\nthree\n";
+		constexpr Sci::string_view sReplaced = "one\nTWO\nthree!\n";
+		CellBuffer cbReplace(true, false);
+		CellBuffer cbEdits(true, false);
+		bool startSequence = false;
+		for (CellBuffer *pcb : { &cbReplace, &cbEdits }) {
+			pcb->SetUndoCollection(false);
+			pcb->InsertString(0, sOriginal.data(), sOriginal.length(), startSequence);
+			pcb->SetUndoCollection(true);
+			pcb->SetSavePoint();
+			pcb->ChangeHistorySet(true);
+		}
+
+		std::vector<LineChange> changes;
+		cbReplace.ReplaceKeepingLines(4, "two\nthree", "TWO\nthree!", changes, startSequence);
+		REQUIRE(changes.size() == 2);
+		cbEdits.BeginUndoAction();
+		cbEdits.InsertString(13, "!", 1, startSequence);
+		cbEdits.DeleteChars(4, 3, startSequence);
+		cbEdits.InsertString(4, "TWO", 3, startSequence);
+		cbEdits.EndUndoAction();
+		REQUIRE(Equal(cbReplace.BufferPointer(), sReplaced));
+		REQUIRE(HistoryOf(cbReplace) == HistoryOf(cbEdits));
+
+		UndoBlock(cbReplace);
+		UndoBlock(cbEdits);
+		REQUIRE(Equal(cbReplace.BufferPointer(), sOriginal));
+		REQUIRE(HistoryOf(cbReplace) == HistoryOf(cbEdits));
+
+		RedoBlock(cbReplace);
+		RedoBlock(cbEdits);
+		REQUIRE(HistoryOf(cbReplace) == HistoryOf(cbEdits));
+
+		// Reverting past a save point
+		cbReplace.SetSavePoint();
+		cbEdits.SetSavePoint();
+		UndoBlock(cbReplace);
+		UndoBlock(cbEdits);
+		REQUIRE(HistoryOf(cbReplace) == HistoryOf(cbEdits));
+		RedoBlock(cbReplace);
+		RedoBlock(cbEdits);
+		REQUIRE(HistoryOf(cbReplace) == HistoryOf(cbEdits));
+	}
+
 	SECTION("StraightUndoRedoSaveRevertRedo") {
 		CellBuffer cb(true, false);
 		cb.SetUndoCollection(false);
@@ -68,4 +68,28 @@ TEST_CASE("CharacterCategoryMap") {
 		REQUIRE(ccm.CategoryFor(0xFFFE) == CharacterCategory::ccCn);
 	}
 
+	SECTION("Supplementary") {
+		// Above the dense range, found through the two stage table
+		REQUIRE(ccm.CategoryFor(0x1F600) == CharacterCategory::ccSo);	// Grinning face emoji
+		REQUIRE(ccm.CategoryFor(0x20000) == CharacterCategory::ccLo);	// CJK Extension B
+		REQUIRE(ccm.CategoryFor(0x1D7CE) == CharacterCategory::ccNd);	// Mathematical bold digit zero
+		REQUIRE(ccm.CategoryFor(0xE0001) == CharacterCategory::ccCf);	// Language tag
+		REQUIRE(ccm.CategoryFor(0x10FFFD) == CharacterCategory::ccCo);
+		REQUIRE(ccm.CategoryFor(0x10FFFF) == CharacterCategory::ccCn);
+		REQUIRE(ccm.CategoryFor(0x110000) == CharacterCategory::ccCn);
+		REQUIRE(ccm.CategoryFor(-1) == CharacterCategory::ccCn);
+	}
+
+	SECTION("MatchesSearch") {
+		// Both table lookups agree with a binary search of the original ranges
+		size_t mismatches = 0;
+		for (int character = 0; character <= 0x10FFFF; character++) {
+			const CharacterCategory searched = SearchCategory(character);
+			if ((ccm.CategoryFor(character) != searched) || (CategoriseCharacter(character) != searched)) {
+				mismatches++;
+			}
+		}
+		REQUIRE(mismatches == 0);
+	}
+
 }
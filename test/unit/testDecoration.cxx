@@ -10,6 +10,8 @@
 #include <algorithm>
 #include <memory>
 
+#include "ScintillaTypes.h"
+
 #include "Debugging.h"
 
 #include "Position.h"
@@ -26,6 +28,36 @@ using namespace Scintilla::Internal;
 
 // Test Decoration.
 
+namespace {
+
+// Implement low quality reproducible pseudo-random numbers.
+// Pseudo-random algorithm based on R. G. Dromey "How to Solve it by Computer" page 122.
+
+class RandomSequence {
+	static constexpr int mult = 109;
+	static constexpr int incr = 853;
+	static constexpr int modulus = 4096;
+	int randomValue = 127;
+public:
+	int Next() noexcept {
+		randomValue = (mult * randomValue + incr) % modulus;
+		return randomValue;
+	}
+};
+
+// Mask of the indicators on at position found from each decoration.
+int MaskOfDecorations(const IDecorationList &decol, Sci::Position position) {
+	int mask = 0;
+	for (const IDecoration *deco : decol.View()) {
+		if (deco->ValueAt(position) && (deco->Indicator() < static_cast<int>(Scintilla::IndicatorNumbers::Ime))) {
+			mask |= 1 << deco->Indicator();
+		}
+	}
+	return mask;
+}
+
+}
+
 TEST_CASE("Decoration") {
 
 	std::unique_ptr<IDecoration> deco = DecorationCreate(false, indicator);
@@ -93,4 +125,80 @@ TEST_CASE("DecorationList") {
 		REQUIRE(decol->End(indicatorB, 5) == 6);
 	}
 
+	SECTION("AllOnAggregate") {
+		decol->InsertSpace(0, 20);
+		decol->SetCurrentIndicator(1);
+		decol->FillRange(2, 1, 6);
+		decol->SetCurrentIndicator(3);
+		decol->FillRange(5, 7, 10);
+		REQUIRE(decol->AllOnFor(0) == 0);
+		REQUIRE(decol->AllOnFor(2) == 0x2);
+		REQUIRE(decol->AllOnFor(5) == 0xA);
+		REQUIRE(decol->AllOnFor(9) == 0x8);
+		REQUIRE(decol->AllOnFor(15) == 0);
+		REQUIRE(decol->AllOnEnd(2) == 5);
+		REQUIRE(decol->AllOnEnd(5) == 8);
+		// Clearing part of one indicator only changes its bit
+		decol->SetCurrentIndicator(1);
+		decol->FillRange(6, 0, 4);
+		REQUIRE(decol->AllOnFor(5) == 0xA);
+		REQUIRE(decol->AllOnFor(6) == 0x8);
+		// Insertion extends indicator 1 which it is inside but not indicator 3 which it starts
+		decol->InsertSpace(5, 3);
+		REQUIRE(decol->AllOnFor(5) == 0x2);
+		REQUIRE(decol->AllOnFor(7) == 0x2);
+		REQUIRE(decol->AllOnFor(8) == 0xA);
+		REQUIRE(decol->AllOnFor(9) == 0x8);
+		decol->DeleteRange(0, 8);
+		REQUIRE(decol->AllOnFor(0) == 0xA);
+		REQUIRE(decol->AllOnFor(1) == 0x8);
+	}
+
+	SECTION("AllOnAggregateRandom") {
+		// Pseudo-random fills, insertions and deletions keep the aggregate equal to the
+		// mask found from each decoration. Indicator 33 is an IME indicator so is excluded.
+		RandomSequence rseq;
+		Sci::Position length = 200;
+		decol->InsertSpace(0, length);
+		size_t mismatches = 0;
+		for (int step = 0; step < 2000; step++) {
+			const int action = rseq.Next() % 4;
+			const Sci::Position position = rseq.Next() % length;
+			const Sci::Position extent = 1 + rseq.Next() % 20;
+			if (action <= 1) {
+				const int indicatorFill = (rseq.Next() % 10 == 0) ? 33 : rseq.Next() % 8;
+				decol->SetCurrentIndicator(indicatorFill);
+				decol->FillRange(position, action, std::min(extent, length - position));
+			} else if (action == 2) {
+				decol->InsertSpace(position, extent);
+				length += extent;
+			} else if (length > 50) {
+				const Sci::Position lengthDelete = std::min(extent, length - position);
+				decol->DeleteRange(position, lengthDelete);
+				length -= lengthDelete;
+			}
+			for (Sci::Position pos = 0; pos < length; pos++) {
+				if (decol->AllOnFor(pos) != MaskOfDecorations(*decol, pos)) {
+					mismatches++;
+				}
+			}
+		}
+		REQUIRE(mismatches == 0);
+	}
+
+	SECTION("VersionChanges") {
+		decol->SetCurrentIndicator(indicator);
+		decol->InsertSpace(0, 9);
+		unsigned int version = decol->Version();
+		decol->FillRange(2, 1, 3);
+		REQUIRE(decol->Version() != version);
+		version = decol->Version();
+		// Filling with the same value changes nothing
+		const FillResult<Sci::Position> fr = decol->FillRange(2, 1, 3);
+		REQUIRE(!fr.changed);
+		REQUIRE(decol->Version() == version);
+		decol->DeleteRange(0, 1);
+		REQUIRE(decol->Version() != version);
+	}
+
 }
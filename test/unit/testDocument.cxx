@@ -540,6 +540,146 @@ TEST_CASE("Document") {
 		#endif
 	}
 
+	SECTION("ReplaceAll") {
+		DocPlus doc("ab ab\nxab ab", 0);
+		doc.document.DeleteUndoHistory();
+		doc.document.AddMark(1, 1);
+		Range range(1, doc.document.Length());
+		const Sci::Position replacements = doc.document.ReplaceAll(range, "ab", 2, "cde", FindOption::MatchCase);
+		REQUIRE(replacements == 3);
+		REQUIRE(doc.Contents() == "ab cde\nxcde cde");
+		REQUIRE(range.start == 1);
+		REQUIRE(range.end == doc.document.Length());
+		REQUIRE(doc.document.LinesTotal() == 2);
+		// Text between matches is not replaced so the marker stays on its line
+		REQUIRE(doc.document.GetMark(1, false) == 2);
+		// Single undo action restores the original
+		REQUIRE(doc.document.CanUndo());
+		doc.document.Undo();
+		REQUIRE(doc.Contents() == "ab ab\nxab ab");
+		REQUIRE(!doc.document.CanUndo());
+
+		// Removing line ends falls back to a separate edit for each match
+		range = Range(0, doc.document.Length());
+		REQUIRE(doc.document.ReplaceAll(range, "\n", 1, " ", FindOption::MatchCase) == 1);
+		REQUIRE(doc.Contents() == "ab ab xab ab");
+		REQUIRE(doc.document.LinesTotal() == 1);
+		doc.document.Undo();
+		REQUIRE(doc.Contents() == "ab ab\nxab ab");
+	}
+
+	SECTION("ReplaceKeepingLines") {
+		DocPlus doc("one\ntwo\nthree\n", 0);
+		doc.document.DeleteUndoHistory();
+		doc.document.AddMark(1, 1);
+		doc.document.decorations->SetCurrentIndicator(0);
+		doc.document.decorations->FillRange(5, 1, 2);
+		// Adding a line is refused without changing the document
+		REQUIRE(!doc.document.ReplaceKeepingLines(4, 3, "t\nwo"));
+		REQUIRE(doc.Contents() == "one\ntwo\nthree\n");
+		REQUIRE(!doc.document.CanUndo());
+
+		REQUIRE(doc.document.ReplaceKeepingLines(0, 13, "ONE\ntwo\nTHREE"));
+		REQUIRE(doc.Contents() == "ONE\ntwo\nTHREE\n");
+		REQUIRE(doc.document.LinesTotal() == 4);
+		REQUIRE(doc.document.LineStart(2) == 8);
+		// Per-line data and decorations of unchanged text are kept
+		REQUIRE(doc.document.GetMark(1, false) == 2);
+		REQUIRE(doc.document.decorations->ValueAt(0, 4) == 0);
+		REQUIRE(doc.document.decorations->ValueAt(0, 5) == 1);
+		REQUIRE(doc.document.decorations->ValueAt(0, 6) == 1);
+		REQUIRE(doc.document.decorations->ValueAt(0, 7) == 0);
+
+		doc.document.Undo();
+		REQUIRE(doc.Contents() == "one\ntwo\nthree\n");
+		REQUIRE(doc.document.GetMark(1, false) == 2);
+		REQUIRE(doc.document.decorations->ValueAt(0, 5) == 1);
+		REQUIRE(!doc.document.CanUndo());
+		doc.document.Redo();
+		REQUIRE(doc.Contents() == "ONE\ntwo\nTHREE\n");
+		REQUIRE(!doc.document.CanRedo());
+	}
+
+	SECTION("ReplaceAllRegex") {
+		DocPlus doc("a1 b22 c333", CpUtf8);
+		Range range(0, doc.document.Length());
+		const Sci::Position replacements = doc.document.ReplaceAll(range, "([a-z])([0-9]+)", 15, "\\2\\1", rePosix);
+		REQUIRE(replacements == 3);
+		REQUIRE(doc.Contents() == "1a 22b 333c");
+		REQUIRE(range.end == doc.document.Length());
+
+		// Empty matches progress by one character
+		range = Range(0, 2);
+		REQUIRE(doc.document.ReplaceAll(range, "x*", 2, "-", rePosix) == 2);
+		REQUIRE(doc.Contents() == "-1-a 22b 333c");
+		REQUIRE(range.end == 4);
+	}
+
+	SECTION("ReplaceWithDiff") {
+		DocPlus doc("one\ntwo\nthree\nfour\nfive\n", 0);
+		doc.document.DeleteUndoHistory();
+		doc.document.AddMark(3, 1);
+		Range range(0, doc.document.Length());
+		const Sci::Position edits = doc.document.ReplaceWithDiff(range, "one\nTwo\nthree\ninserted\nfour\nfive\n");
+		REQUIRE(edits == 2);
+		REQUIRE(range.end == doc.document.Length());
+		REQUIRE(doc.Contents() == "one\nTwo\nthree\ninserted\nfour\nfive\n");
+		// Marker stays on "four"
+		REQUIRE(doc.document.GetMark(4, false) == 2);
+		doc.document.Undo();
+		REQUIRE(doc.Contents() == "one\ntwo\nthree\nfour\nfive\n");
+		REQUIRE(!doc.document.CanUndo());
+
+		// Deleting and changing lines at both ends
+		range = Range(0, doc.document.Length());
+		doc.document.ReplaceWithDiff(range, "two\nthree\nfour\nsix\n");
+		REQUIRE(doc.Contents() == "two\nthree\nfour\nsix\n");
+		REQUIRE(doc.document.GetMark(2, false) == 2);
+		range = Range(0, doc.document.Length());
+		REQUIRE(doc.document.ReplaceWithDiff(range, "two\nthree\nfour\nsix\n") == 0);
+
+		// Nothing changes in a read-only document so the range keeps its length
+		doc.document.SetReadOnly(true);
+		range = Range(0, doc.document.Length());
+		REQUIRE(doc.document.ReplaceWithDiff(range, "two\nsix\n") == 0);
+		REQUIRE(doc.Contents() == "two\nthree\nfour\nsix\n");
+		REQUIRE(range.end == doc.document.Length());
+	}
+
+	SECTION("Indent") {
+		DocPlus doc("a\n\n  b\n\tc\n", 0);
+		doc.document.DeleteUndoHistory();
+		doc.document.tabInChars = 4;
+		doc.document.actualIndentInChars = 4;
+		doc.document.useTabs = false;
+		doc.document.AddMark(2, 1);
+		doc.document.Indent(true, 3, 0);
+		// Empty lines are not indented when indenting forwards
+		REQUIRE(doc.Contents() == "    a\n\n      b\n        c\n");
+		REQUIRE(doc.document.GetMark(2, false) == 2);
+		// Lines are kept through undo and redo
+		doc.document.Undo();
+		REQUIRE(doc.Contents() == "a\n\n  b\n\tc\n");
+		REQUIRE(doc.document.GetMark(2, false) == 2);
+		REQUIRE(!doc.document.CanUndo());
+		doc.document.Redo();
+		REQUIRE(doc.Contents() == "    a\n\n      b\n        c\n");
+		REQUIRE(doc.document.GetMark(2, false) == 2);
+		doc.document.Undo();
+
+		doc.document.useTabs = true;
+		doc.document.Indent(false, 3, 0);
+		REQUIRE(doc.Contents() == "a\n\nb\nc\n");
+		doc.document.Undo();
+		doc.document.Indent(true, 3, 2);
+		REQUIRE(doc.Contents() == "a\n\n\t  b\n\t\tc\n");
+		REQUIRE(doc.document.GetMark(2, false) == 2);
+		// A single line is a minimal edit
+		doc.document.Indent(false, 2, 2);
+		REQUIRE(doc.Contents() == "a\n\n  b\n\t\tc\n");
+		REQUIRE(doc.document.GetMark(2, false) == 2);
+	}
+
 	SECTION("RegexAssertion") {
 		DocPlus doc("ab cd ef\r\ngh ij kl", CpUtf8);
 		const Sci::Position docLength = doc.document.Length();
@@ -389,3 +389,64 @@ TEST_CASE("LineTabstops") {
 		REQUIRE(0 == lt.GetNextTabstop(0, 0));
 	}
 }
+
+TEST_CASE("LineWidths") {
+
+	LineWidths lw;
+
+	SECTION("Initial") {
+		// Initial State
+		REQUIRE(0 == lw.Lines());
+		REQUIRE(0 == lw.MaxWidth());
+		REQUIRE(0 == lw.NextUnmeasured(0));
+		REQUIRE(0 == lw.Unmeasured());
+	}
+
+	SECTION("EstimateAndMeasure") {
+		lw.InsertLines(0, 3);
+		REQUIRE(3 == lw.Lines());
+		REQUIRE(0 == lw.NextUnmeasured(0));
+		lw.SetWidth(0, 100, false);
+		lw.SetWidth(1, 300, false);
+		lw.SetWidth(2, 200, false);
+		REQUIRE(300 == lw.MaxWidth());
+		REQUIRE(!lw.Measured(1));
+		// Measuring the widest line narrower finds the new widest
+		lw.SetWidth(1, 150, true);
+		REQUIRE(lw.Measured(1));
+		REQUIRE(150 == lw.Width(1));
+		REQUIRE(200 == lw.MaxWidth());
+		REQUIRE(0 == lw.NextUnmeasured(0));
+		lw.SetWidth(0, 90, true);
+		REQUIRE(2 == lw.NextUnmeasured(0));
+		lw.SetWidth(2, 210, true);
+		REQUIRE(3 == lw.NextUnmeasured(0));
+		REQUIRE(0 == lw.Unmeasured());
+		REQUIRE(210 == lw.MaxWidth());
+		// Needing a width again before the search position is found from the start
+		lw.SetWidth(0, 90, false);
+		REQUIRE(1 == lw.Unmeasured());
+		REQUIRE(0 == lw.NextUnmeasured(2));
+	}
+
+	SECTION("InsertRemoveLine") {
+		lw.InsertLines(0, 2);
+		lw.SetWidth(0, 100, true);
+		lw.SetWidth(1, 200, true);
+		lw.InsertLine(1);
+		REQUIRE(3 == lw.Lines());
+		REQUIRE(!lw.Measured(1));
+		REQUIRE(1 == lw.Unmeasured());
+		REQUIRE(1 == lw.NextUnmeasured(0));
+		REQUIRE(200 == lw.Width(2));
+		REQUIRE(200 == lw.MaxWidth());
+		lw.RemoveLine(2);
+		REQUIRE(2 == lw.Lines());
+		REQUIRE(100 == lw.MaxWidth());
+		lw.RemoveLine(1);
+		REQUIRE(0 == lw.Unmeasured());
+		lw.Init();
+		REQUIRE(0 == lw.Lines());
+		REQUIRE(0 == lw.MaxWidth());
+	}
+}
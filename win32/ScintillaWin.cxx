@@ -2008,6 +2008,7 @@ sptr_t ScintillaWin::SciMessage(Message iMessage, uptr_t wParam, sptr_t lParam)
 		break;
 
 	case Message::TargetAsUTF8:
+		CommitAppended();
 		return TargetAsUTF8(CharPtrFromSPtr(lParam));
 
 	case Message::EncodedFromUTF8:
@@ -2195,9 +2196,11 @@ sptr_t ScintillaWin::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 			return ::DefWindowProc(MainHWND(), msg, wParam, lParam);
 
 		case WM_GETTEXTLENGTH:
+			CommitAppended();
 			return GetTextLength();
 
 		case WM_GETTEXT:
+			CommitAppended();
 			return GetText(wParam, lParam);
 
 		case WM_INPUTLANGCHANGE: